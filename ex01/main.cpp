@@ -44,9 +44,56 @@ void test_linear_combination_arbitrary_vectors() {
     std::cout << "Test linear combination with arbitrary vectors passed.\n";
 }
 
+void test_linear_combination_many_terms() {
+    // Enough terms for the 4-term groups plus a remainder, and long enough
+    // vectors (n >= 3 * 4 * LINEAR_COMBINATION_CHUNK) for three threads whose
+    // ranges each end in a partial chunk
+    size_t terms = 103, n = 20000;
+    std::vector<Vector<f32>> u;
+    std::vector<f32> coefs;
+    for (size_t t = 0; t < terms; t++) {
+        std::vector<f32> data(n);
+        for (size_t j = 0; j < n; j++)
+            data[j] = f32((t * 31 + j * 7) % 17) - 8.0f;
+        u.push_back(Vector<f32>(data));
+        coefs.push_back(f32(t % 5) * 0.25f - 0.5f);
+    }
+
+    Vector<f32> expected = u[0] * coefs[0];
+    for (size_t t = 1; t < terms; t++)
+        expected += u[t] * coefs[t];
+
+    assert(vectorsEqual(linear_combination(u, coefs), expected, 1e-3f));
+    // Three threads even on a single core machine
+    assert(vectorsEqual(linear_combination_parallel(u, coefs, 3), expected, 1e-3f));
+    assert(vectorsEqual(linear_combination_parallel(u, coefs), expected, 1e-3f));
+    std::cout << "Test linear combination with many long vectors passed.\n";
+}
+
+void test_linear_combination_errors() {
+    bool thrown = false;
+    try {
+        linear_combination(std::vector<Vector<f32>>{Vector<f32>({1, 2}), Vector<f32>({1})}, {1.f, 2.f});
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    thrown = false;
+    try {
+        linear_combination(std::vector<Vector<f32>>{}, {});
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test linear combination errors passed.\n";
+}
+
 int main() {
     test_linear_combination_basis_vectors();
     test_linear_combination_arbitrary_vectors();
+    test_linear_combination_many_terms();
+    test_linear_combination_errors();
     
     std::cout << "✅ All unit tests passed!\n";
     return 0;
@@ -1,6 +1,7 @@
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include "../includes/interpolation.hpp"
 #include <iostream>
 #include <cassert>
 #include <cmath>
@@ -80,11 +81,81 @@ void test_matrix_lerp() {
     std::cout << "Matrix lerp tests PASSED" << std::endl;
 }
 
+// Test batched lerp on vec3 (scalar path) and mat4 (SIMD path) buffers
+void test_lerp_batch() {
+    std::cout << "Testing batched lerp..." << std::endl;
+
+    size_t count = 5;
+    std::vector<float> t = {0.0f, 0.25f, 0.5f, 1.0f, 1.5f};
+    for (size_t dim : {3, 4, 16}) {
+        std::vector<float> a(count * dim), b(count * dim), out(count * dim);
+        for (size_t k = 0; k < a.size(); k++) {
+            a[k] = float(k % 7) - 3.0f;
+            b[k] = float(k % 5) * 2.0f;
+        }
+        lerp_batch(a.data(), b.data(), t.data(), out.data(), count, dim);
+        for (size_t i = 0; i < count; i++)
+            for (size_t c = 0; c < dim; c++)
+                assert(almostEqual(out[i * dim + c], lerp(a[i * dim + c], b[i * dim + c], t[i]), 1e-5f));
+
+        // In place: the output may alias the start buffer
+        lerp_batch(a.data(), b.data(), t.data(), a.data(), count, dim);
+        for (size_t k = 0; k < a.size(); k++)
+            assert(almostEqual(a[k], out[k]));
+    }
+
+    std::vector<double> ma(16, 1.0), mb(16, 3.0), mo(16), mt = {0.5};
+    lerp_mat4_batch(ma.data(), mb.data(), mt.data(), mo.data(), 1);
+    for (double x : mo)
+        assert(x == 2.0);
+
+    std::cout << "Batched lerp tests PASSED" << std::endl;
+}
+
+// Test quaternion nlerp/slerp against rotations about the z axis
+void test_quaternion_batch() {
+    std::cout << "Testing batched nlerp/slerp..." << std::endl;
+
+    const float pi = float(M_PI);
+    // (x, y, z, w): identity, then 90° about z, and -q (same rotation) for the shortest arc test
+    std::vector<float> a = {0, 0, 0, 1,  0, 0, 0, 1,  0, 0, 0, 1};
+    float s = std::sin(pi / 4), c = std::cos(pi / 4);
+    std::vector<float> b = {0, 0, s, c,  0, 0, s, c,  0, 0, -s, -c};
+    std::vector<float> t = {0.5f, 0.25f, 0.5f};
+    std::vector<float> out(12);
+
+    slerp_batch(a.data(), b.data(), t.data(), out.data(), 3);
+    // slerp has constant angular speed: t = 0.25 is a 22.5° rotation
+    float angles[] = {pi / 4, pi / 8, pi / 4};
+    for (size_t i = 0; i < 3; i++) {
+        assert(almostEqual(out[4 * i + 2], std::sin(angles[i] / 2), 1e-5f));
+        assert(almostEqual(out[4 * i + 3], std::cos(angles[i] / 2), 1e-5f));
+    }
+
+    nlerp_batch(a.data(), b.data(), t.data(), out.data(), 3);
+    for (size_t i = 0; i < 3; i++) {
+        float len = std::sqrt(out[4 * i + 2] * out[4 * i + 2] + out[4 * i + 3] * out[4 * i + 3]);
+        assert(almostEqual(len, 1.0f, 1e-5f));
+        assert(out[4 * i + 3] > 0);     // took the short arc even for -q
+    }
+    // nlerp and slerp agree at the midpoint
+    assert(almostEqual(out[2], std::sin(pi / 8), 1e-5f));
+
+    // Nearly parallel quaternions go through the normalised lerp fallback
+    std::vector<double> qa = {0, 0, 0, 1}, qb = {0, 0, 1e-4, 1}, qt = {0.5}, qo(4);
+    slerp_batch(qa.data(), qb.data(), qt.data(), qo.data(), 1);
+    assert(std::fabs(qo[0] * qo[0] + qo[1] * qo[1] + qo[2] * qo[2] + qo[3] * qo[3] - 1.0) < 1e-12);
+
+    std::cout << "Batched nlerp/slerp tests PASSED" << std::endl;
+}
+
 int main() {
     
     test_scalar_lerp();
     test_vector_lerp();
     test_matrix_lerp();
+    test_lerp_batch();
+    test_quaternion_batch();
     
     std::cout << "✅ All unit tests passed!\n";
     return 0;
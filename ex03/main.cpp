@@ -1,5 +1,7 @@
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <vector>
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
@@ -62,12 +64,50 @@ void test_zero_vector() {
     std::cout << "Zero vector dot product test passed: " << result << " == 0" << std::endl;
 }
 
+// Compare the summation modes on a long f32 dot product against a double reference
+void test_summation_modes() {
+    std::cout << "\nTesting dot product summation modes..." << std::endl;
+
+    const size_t n = 1 << 20;
+    std::vector<f32> a(n);
+    std::vector<f32> b(n);
+    double exact = 0;
+    f32 serial = 0;
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = 0.1f + f32(i % 7) * 0.01f;
+        b[i] = (i % 2 == 0) ? 1.0f : 0.5f;
+        exact += double(a[i]) * double(b[i]);
+        serial += a[i] * b[i];
+    }
+    Vector<f32> v(a);
+    Vector<f32> u(b);
+
+    double err_serial = std::abs(serial - exact) / exact;
+    double err_fast = std::abs(dot(v, u) - exact) / exact;
+    double err_pairwise = std::abs(dot(v, u, Summation::Pairwise) - exact) / exact;
+    double err_kahan = std::abs(dot(v, u, Summation::Kahan) - exact) / exact;
+    std::cout << "Relative errors: serial " << err_serial << ", fast " << err_fast
+              << ", pairwise " << err_pairwise << ", kahan " << err_kahan << std::endl;
+    assert(err_fast <= err_serial);
+    assert(err_pairwise < 1e-6);
+    assert(err_kahan < 1e-7);
+
+    // Short and odd sizes go through the remainder loops
+    Vector<f32> w({1, 2, 3, 4, 5});
+    assert(dot(w, w, Summation::Fast) == 55);
+    assert(dot(w, w, Summation::Pairwise) == 55);
+    assert(dot(w, w, Summation::Kahan) == 55);
+    assert(w.dot(w) == 55);
+    std::cout << "Summation mode tests passed!" << std::endl;
+}
+
 int main() {
     std::cout << "Running Vector dot product tests...\n" << std::endl;
     
     test_vector_dot_product();
     test_standalone_dot_function();
     test_zero_vector();
+    test_summation_modes();
     
     std::cout << "✅ All unit tests passed!\n";
     return 0;
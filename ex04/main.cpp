@@ -1,9 +1,11 @@
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include "../includes/matrix_reductions.hpp"
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 // Utility function to check if two floats are approximately equal
 bool approx_equal(f32 a, f32 b, f32 epsilon = 1e-5f) {
@@ -151,6 +153,86 @@ void test_edge_cases() {
     std::cout << "Edge case tests passed!" << std::endl;
 }
 
+// Test the selectable summation modes and the multi-accumulator max
+void test_reductions() {
+    std::cout << "Testing reduction modes..." << std::endl;
+
+    const size_t n = 1 << 20;
+    std::vector<f32> data(n);
+    double exact_1 = 0;
+    double exact_2 = 0;
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = (i % 3 == 0 ? -1.0f : 1.0f) * (0.3f + f32(i % 11) * 0.07f);
+        exact_1 += std::abs(double(data[i]));
+        exact_2 += double(data[i]) * double(data[i]);
+    }
+    Vector<f32> v(data);
+    assert(std::abs(norm_1(v, Summation::Pairwise) - exact_1) / exact_1 < 1e-6);
+    assert(std::abs(norm_1(v, Summation::Kahan) - exact_1) / exact_1 < 1e-7);
+    assert(std::abs(norm(v, Summation::Pairwise) - std::sqrt(exact_2)) / std::sqrt(exact_2) < 1e-6);
+    assert(std::abs(norm(v, Summation::Kahan) - std::sqrt(exact_2)) / std::sqrt(exact_2) < 1e-7);
+    assert(norm_1(Vector<f32>(std::vector<f32>{})) == 0);
+
+    // The maximum in every accumulator lane and in the remainder
+    for (size_t pos = 0; pos < 11; ++pos) {
+        std::vector<f32> w(11, -2.0f);
+        w[pos] = 3.0f;
+        w[(pos + 5) % 11] = -7.0f;
+        assert(Vector<f32>(w).max() == 3.0f);
+        assert(norm_inf(Vector<f32>(w)) == 7.0f);
+    }
+    std::cout << "Reduction tests passed!" << std::endl;
+}
+
+// Test row-wise and column-wise reductions against the vector functions
+void test_matrix_reductions() {
+    std::cout << "Testing matrix axis reductions..." << std::endl;
+
+    Matrix<f32> A({{1, -2, 3}, {-4, 5, -6}});
+    assert(row_sums(A) == Vector<f32>({2, -5}));
+    assert(col_sums(A) == Vector<f32>({-3, 3, -3}));
+    assert(row_norms(A, NormKind::L1) == Vector<f32>({6, 15}));
+    assert(col_norms(A, NormKind::L1) == Vector<f32>({5, 7, 9}));
+    assert(row_norms(A, NormKind::Inf) == Vector<f32>({3, 6}));
+    assert(col_norms(A, NormKind::Inf) == Vector<f32>({4, 5, 6}));
+    assert(approx_equal(row_norms(A)[0], norm(Vector<f32>({1, -2, 3}))));
+    assert(approx_equal(col_norms(A)[2], norm(Vector<f32>({3, -6}))));
+    assert(row_max(A) == Vector<f32>({3, 5}));
+    assert(row_argmax(A) == Vector<size_t>({2, 1}));
+    assert(col_max(A) == Vector<f32>({1, 5, 3}));
+    assert(col_argmax(A) == Vector<size_t>({0, 1, 0}));
+
+    // Large enough to be split over several threads on both axes
+    const size_t rows = 300;
+    const size_t cols = 200;
+    std::vector<std::vector<f32>> data(rows, std::vector<f32>(cols));
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            data[i][j] = f32((i * 7 + j * 13) % 29) - 14.0f;
+    Matrix<f32> B(data);
+    Vector<f32> rs = row_sums(B, 4);
+    Vector<f32> cn = col_norms(B, NormKind::L2, 4);
+    Vector<f32> cm;
+    Vector<size_t> ca = col_argmax(B, &cm, 4);
+    Vector<size_t> ra = row_argmax(B, 4);
+    for (size_t i = 0; i < rows; ++i) {
+        Vector<f32> r(data[i]);
+        assert(approx_equal(rs[i], dot(r, Vector<f32>(std::vector<f32>(cols, 1.0f))), 1e-3f));
+        assert(data[i][ra[i]] == r.max());
+    }
+    for (size_t j = 0; j < cols; ++j) {
+        std::vector<f32> column(rows);
+        for (size_t i = 0; i < rows; ++i)
+            column[i] = data[i][j];
+        Vector<f32> c(column);
+        assert(approx_equal(cn[j], norm(c), 1e-3f));
+        assert(cm[j] == c.max() && data[ca[j]][j] == c.max());
+        for (size_t i = 0; i < ca[j]; ++i)
+            assert(data[i][j] < cm[j]);
+    }
+    std::cout << "Matrix axis reduction tests passed!" << std::endl;
+}
+
 int main() {
     std::cout << "===== Running Vector Norm Tests =====" << std::endl;
     
@@ -160,6 +242,8 @@ int main() {
     test_normalize_function();
     test_normalize_method();
     test_edge_cases();
+    test_reductions();
+    test_matrix_reductions();
     
     std::cout << "✅ All unit tests passed!\n";
     return 0;
@@ -4,6 +4,8 @@
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include "../includes/knn.hpp"
+#include <vector>
 
 // Helper function to check if two floating point values are approximately equal
 bool approxEqual(float a, float b, float epsilon = 1e-5f) {
@@ -47,9 +49,110 @@ void testAngleCos() {
     }
 }
 
+// Deterministic pseudo-random vector with components in [-1, 1)
+Vector<f32> pseudoRandomVector(size_t dim, unsigned& state) {
+    std::vector<f32> data(dim);
+    for (size_t i = 0; i < dim; ++i) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = f32(state >> 8) / f32(1u << 23) - 1.0f;
+    }
+    return Vector<f32>(data);
+}
+
+// Brute force reference: index of the stored vector closest to the query
+size_t bruteForceNearest(const std::vector<Vector<f32>>& stored, const Vector<f32>& query, Metric metric) {
+    size_t best = 0;
+    f32 best_score = 0;
+    for (size_t i = 0; i < stored.size(); ++i) {
+        f32 s = metric == Metric::Cosine ? -angle_cos(stored[i], query) : norm(stored[i] - query);
+        if (i == 0 || s < best_score) {
+            best = i;
+            best_score = s;
+        }
+    }
+    return best;
+}
+
+void testVectorCollection() {
+    std::cout << "Testing VectorCollection search..." << std::endl;
+    const size_t dim = 12;
+    const size_t count = 700;
+    unsigned state = 42;
+    std::vector<Vector<f32>> stored;
+    VectorCollection<f32> cosine(dim, Metric::Cosine);
+    VectorCollection<f32> l2(dim, Metric::L2);
+    for (size_t i = 0; i < count; ++i) {
+        stored.push_back(pseudoRandomVector(dim, state));
+        assert(cosine.add(stored.back()) == i);
+        l2.add(stored.back());
+    }
+    assert(cosine.size() == count && l2.dim() == dim);
+    assert(approxEqual(norm(Vector<f32>(std::vector<f32>(cosine.row(5), cosine.row(5) + dim))), 1.0f));
+
+    std::vector<Vector<f32>> queries;
+    for (size_t q = 0; q < 6; ++q)
+        queries.push_back(pseudoRandomVector(dim, state));
+
+    for (VectorCollection<f32>* c : {&cosine, &l2}) {
+        std::vector<std::vector<Neighbor<f32>>> batch = c->search_batch(queries, 5, 3);
+        for (size_t q = 0; q < queries.size(); ++q) {
+            std::vector<Neighbor<f32>> single = c->search(queries[q], 5, 0, 1);
+            assert(single.size() == 5 && batch[q].size() == 5);
+            assert(single[0].index == bruteForceNearest(stored, queries[q], c->metric()));
+            for (size_t i = 0; i < 5; ++i) {
+                assert(single[i].index == batch[q][i].index);
+                if (i > 0 && c->metric() == Metric::Cosine)
+                    assert(single[i - 1].score >= single[i].score);
+                if (i > 0 && c->metric() == Metric::L2)
+                    assert(single[i - 1].score <= single[i].score);
+            }
+        }
+        if (c->metric() == Metric::Cosine)
+            assert(approxEqual(c->search(queries[0], 1)[0].score,
+                               angle_cos(stored[c->search(queries[0], 1)[0].index], queries[0])));
+        else
+            assert(approxEqual(c->search(queries[0], 1)[0].score,
+                               std::pow(norm(stored[c->search(queries[0], 1)[0].index] - queries[0]), 2.0f), 1e-4f));
+    }
+
+    // IVF: probing every list is exhaustive, a stored vector is found in its own list
+    cosine.build_index(8, 5, 2);
+    assert(cosine.indexed());
+    for (size_t q = 0; q < queries.size(); ++q)
+        assert(cosine.search(queries[q], 3, 8)[0].index == cosine.search(queries[q], 3)[0].index);
+    assert(cosine.search(stored[123], 1, 1)[0].index == 123);
+    size_t added = cosine.add(queries[0]);
+    assert(cosine.search(queries[0], 1, 1)[0].index == added);
+
+    // More neighbours than rows and k = 0
+    VectorCollection<f32> small(2, Metric::L2);
+    small.add(Vector<f32>({0, 0}));
+    small.add(Vector<f32>({3, 4}));
+    std::vector<Neighbor<f32>> all = small.search(Vector<f32>({3, 3}), 10);
+    assert(all.size() == 2 && all[0].index == 1 && approxEqual(all[0].score, 1.0f) && approxEqual(all[1].score, 18.0f));
+    assert(small.search(Vector<f32>({3, 3}), 0).empty());
+
+    bool thrown = false;
+    try {
+        cosine.add(Vector<f32>({1, 2}));
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        small.build_index(3);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "VectorCollection tests passed!" << std::endl;
+}
+
 int main() {
     std::cout << "Running angle_cos tests..." << std::endl;
     testAngleCos();
+    testVectorCollection();
     std::cout << "✅ All unit tests passed!\n";
     
     return 0;
@@ -1,8 +1,13 @@
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include "../includes/mesh.hpp"
+#include "../includes/quaternion.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 
 // Helper function to compare vectors with a small epsilon for floating point comparison
@@ -72,9 +77,180 @@ void test_method() {
     assert(vector_equals(v2, expected2));
     std::cout << "Method test case 1 passed!" << std::endl;
     }
+void test_cross_batch() {
+    std::cout << "Testing batched cross product..." << std::endl;
+
+    // 13 vectors: one AVX block, one SSE block and a scalar tail
+    const size_t n = 13;
+    Points3<f32> a;
+    Points3<f32> b;
+    Points3<f32> out;
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        a.push_back(f32(i) - 6, f32(i % 5) + 1, 2 - f32(i % 3));
+        b.push_back(f32(i % 4) - 1, 3 - f32(i), f32(i % 7) * 0.5f);
+    }
+    cross_batch(a.x.data(), a.y.data(), a.z.data(), b.x.data(), b.y.data(), b.z.data(),
+                out.x.data(), out.y.data(), out.z.data(), n);
+    normalize_batch(a.x.data(), a.y.data(), a.z.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        Vector<f32> u({f32(i) - 6, f32(i % 5) + 1, 2 - f32(i % 3)});
+        Vector<f32> v({f32(i % 4) - 1, 3 - f32(i), f32(i % 7) * 0.5f});
+        assert(vector_equals(Vector<f32>({out.x[i], out.y[i], out.z[i]}), cross_product(u, v)));
+        assert(vector_equals(Vector<f32>({a.x[i], a.y[i], a.z[i]}), normalize(u)));
+    }
+
+    // Zero vectors are left at zero
+    std::vector<f32> zero(5, 0.0f);
+    normalize_batch(zero.data(), zero.data(), zero.data(), zero.size());
+    for (f32 z : zero)
+        assert(z == 0.0f);
+    std::cout << "Batched cross product tests passed!" << std::endl;
+}
+
+void test_mesh_normals() {
+    std::cout << "Testing mesh normals..." << std::endl;
+
+    // Octahedron with mixed OBJ face syntaxes, a quad split into a fan and negative indices
+    const char* path = "ex06_octahedron.obj";
+    {
+        std::ofstream obj(path);
+        obj << "# octahedron\nv 1 0 0\nv -1 0 0\nv 0 1 0\nv 0 -1 0\nv 0 0 1\nv 0 0 -1\n"
+            << "f 1/1/1 3/2/1 5/3/1\nf 3//2 2//2 5//2\nf 2 4 5\nf -3 -6 -2\n"
+            << "f 3/1 1/1 6/1\nf 2 3 6\nf 4 2 6\nf 1 4 6\n";
+    }
+    Mesh<f32> mesh = load_obj(path);
+    std::remove(path);
+    assert(mesh.vertices.size() == 6 && mesh.triangles() == 8);
+
+    Points3<f32> faces;
+    face_normals(mesh, faces, true, 3);
+    const f32 c = 1.0f / std::sqrt(3.0f);
+    assert(vector_equals(Vector<f32>({faces.x[0], faces.y[0], faces.z[0]}), Vector<f32>({c, c, c})));
+    assert(vector_equals(Vector<f32>({faces.x[7], faces.y[7], faces.z[7]}), Vector<f32>({c, -c, -c})));
+
+    Points3<f32> areas;
+    face_normals(mesh, areas, false);
+    assert(std::abs(norm(Vector<f32>({areas.x[2], areas.y[2], areas.z[2]})) - 2 * std::sqrt(3.0f) / 2) < 1e-5f);
+
+    // By symmetry every vertex normal points away from the centre
+    Points3<f32> vertices;
+    vertex_normals(mesh, vertices, 2);
+    for (size_t i = 0; i < 6; ++i)
+        assert(vector_equals(Vector<f32>({vertices.x[i], vertices.y[i], vertices.z[i]}),
+                             Vector<f32>({mesh.vertices.x[i], mesh.vertices.y[i], mesh.vertices.z[i]})));
+
+    // Quad split into two triangles sharing the first vertex
+    {
+        std::ofstream obj(path);
+        obj << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n";
+    }
+    Mesh<f32> quad = load_obj(path);
+    std::remove(path);
+    assert(quad.triangles() == 2 && quad.indices[3] == 0 && quad.indices[5] == 3);
+
+    bool thrown = false;
+    try {
+        quad.indices.push_back(7);
+        quad.indices.push_back(0);
+        quad.indices.push_back(1);
+        face_normals(quad, faces);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        load_obj("missing_file.obj");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Mesh normal tests passed!" << std::endl;
+}
+
+double max_abs_diff(const Matrix<double>& A, const Matrix<double>& B) {
+    double m = 0;
+    for (size_t i = 0; i < A.getRows(); ++i)
+        for (size_t j = 0; j < A.getCols(); ++j)
+            m = std::max(m, std::fabs(A[i][j] - B[i][j]));
+    return m;
+}
+
+void test_quaternion() {
+    std::cout << "Testing quaternions..." << std::endl;
+    const double pi = std::acos(-1.0);
+
+    // A quarter turn about z takes x to y
+    Quaternion<f32> qz = Quaternion<f32>::from_axis_angle(Vector<f32>({0, 0, 2}), f32(pi / 2));
+    assert(vector_equals(qz.rotate(Vector<f32>({1, 0, 0})), Vector<f32>({0, 1, 0})));
+
+    // Composition matches the product of the matrices, in float and double
+    Quaternion<double> p = Quaternion<double>::from_axis_angle(Vector<double>({1, 2, 3}), 0.8);
+    Quaternion<double> q = Quaternion<double>::from_axis_angle(Vector<double>({-1, 0.5, 0}), 2.1);
+    assert(max_abs_diff((p * q).to_matrix3(), mul_mat(p.to_matrix3(), q.to_matrix3())) < 1e-14);
+    assert(max_abs_diff((p * q.inverse()).to_matrix4(), mul_mat(p.to_matrix4(), transpose(q.to_matrix4()))) < 1e-14);
+    Quaternion<f32> pf(f32(p.w()), f32(p.x()), f32(p.y()), f32(p.z()));
+    Quaternion<f32> qf(f32(q.w()), f32(q.x()), f32(q.y()), f32(q.z()));
+    Quaternion<f32> pqf = pf * qf;
+    Quaternion<double> pq = p * q;
+    for (size_t i = 0; i < 4; ++i)
+        assert(std::fabs(double(pqf.data()[i]) - pq.data()[i]) < 1e-6);
+
+    // Round trip through a matrix, including the half turns of each branch
+    std::vector<Quaternion<double>> rotations = {p, q, pq,
+        Quaternion<double>(0, 1, 0, 0), Quaternion<double>(0, 0, 1, 0), Quaternion<double>(0, 0, 0, 1),
+        Quaternion<double>::from_axis_angle(Vector<double>({1, 1, 0}), pi)};
+    for (const Quaternion<double>& r : rotations) {
+        Quaternion<double> back = Quaternion<double>::from_matrix(r.to_matrix4());
+        assert(std::fabs(std::fabs(dot(back, r)) - 1) < 1e-12);
+    }
+
+    // Slerp: end points, constant angular speed, shorter arc
+    Quaternion<double> id;
+    Quaternion<double> turn = Quaternion<double>::from_axis_angle(Vector<double>({0, 1, 0}), 1.2);
+    assert(std::fabs(dot(slerp(id, turn, 0.0), id) - 1) < 1e-12);
+    assert(std::fabs(dot(slerp(id, turn, 1.0), turn) - 1) < 1e-12);
+    Quaternion<double> third = slerp(id, turn, 1.0 / 3);
+    assert(std::fabs(2 * std::acos(third.w()) - 0.4) < 1e-12);
+    Quaternion<double> flipped(-turn.w(), -turn.x(), -turn.y(), -turn.z());
+    assert(std::fabs(dot(slerp(id, flipped, 1.0 / 3), third)) > 1 - 1e-12);
+    Quaternion<f32> half = slerp(Quaternion<f32>(), Quaternion<f32>::from_axis_angle(Vector<f32>({0, 1, 0}), 1.2f), 0.5f);
+    assert(std::fabs(half.norm() - 1) < 1e-6f && std::fabs(2 * std::acos(half.w()) - 0.6f) < 1e-5f);
+
+    // Drift from many compositions is removed by normalize()
+    Quaternion<f32> step = Quaternion<f32>::from_axis_angle(Vector<f32>({0.3f, -1, 0.2f}), 0.01f);
+    Quaternion<f32> acc;
+    for (int i = 0; i < 10000; ++i)
+        acc = acc * step;
+    acc.normalize();
+    assert(std::fabs(acc.norm() - 1) < 1e-6f);
+
+    // Batched rotation: 37 points cover the AVX, SSE and scalar paths
+    Points3<f32> pts;
+    for (size_t i = 0; i < 37; ++i)
+        pts.push_back(f32(i) - 18, f32(i % 5) * 0.5f, 3 - f32(i % 4));
+    Points3<f32> rotated;
+    rotate(pf, pts, rotated, 2);
+    Matrix<f32> R = pf.to_matrix3();
+    for (size_t i = 0; i < pts.size(); ++i) {
+        Vector<f32> v({pts.x[i], pts.y[i], pts.z[i]});
+        Vector<f32> expected = mul_vec(R, v);
+        assert(vector_equals(Vector<f32>({rotated.x[i], rotated.y[i], rotated.z[i]}), expected, 1e-4f));
+        assert(vector_equals(pf.rotate(v), expected, 1e-4f));
+    }
+    rotate(pf, pts, pts);
+    for (size_t i = 0; i < pts.size(); ++i)
+        assert(pts.x[i] == rotated.x[i] && pts.y[i] == rotated.y[i] && pts.z[i] == rotated.z[i]);
+    std::cout << "Quaternion tests passed!" << std::endl;
+}
+
 int main() {
     test_cross_product();
     test_method();
+    test_cross_batch();
+    test_mesh_normals();
+    test_quaternion();
     std::cout << "✅ All unit tests passed!\n";
     return 0;
 }
\ No newline at end of file
@@ -1,8 +1,14 @@
+#include "../includes/chain.hpp"
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include "../includes/half.hpp"
+#include "../includes/packed.hpp"
+#include "../includes/quantized.hpp"
+#include "../includes/blas.hpp"
 #include <cassert>
 #include <cmath>
+#include <complex>
 #include <iostream>
 
 // Helper function to compare floats with tolerance
@@ -138,6 +144,400 @@ void test_mul_mat_member() {
     std::cout << "Member matrix-matrix multiplication test passed!" << std::endl;
 }
 
+void test_half_conversions() {
+    std::cout << "Testing f16/bf16 conversions..." << std::endl;
+
+    assert(float(f16(1.0f)) == 1.0f);
+    assert(f16(1.0f).bits == 0x3c00);
+    assert(float(f16(65504.0f)) == 65504.0f);
+    assert(std::isinf(float(f16(65520.0f))));
+    assert(float(f16(std::ldexp(1.0f, -24))) == std::ldexp(1.0f, -24));  // smallest subnormal
+    assert(float(f16(1e-8f)) == 0.0f);
+    assert(float(f16(-2.5f)) == -2.5f);
+    // 1 + 2^-11 is halfway between two halves and rounds to even
+    assert(float(f16(1.0f + std::ldexp(1.0f, -11))) == 1.0f);
+    assert(std::isnan(float(f16(NAN))));
+
+    assert(bf16(1.0f).bits == 0x3f80);
+    assert(float(bf16(-3.0f)) == -3.0f);
+    assert(float(bf16(1e30f)) > 9.9e29f);
+
+    std::cout << "f16/bf16 conversion tests passed!" << std::endl;
+}
+
+template <typename H>
+void check_half_kernels(f32 tol) {
+    // Sizes chosen so every SIMD width leaves a scalar tail
+    size_t m = 13, n = 37, p = 19;
+    std::vector<std::vector<f32>> a(m, std::vector<f32>(n)), b(n, std::vector<f32>(p));
+    std::vector<f32> x(n);
+    for (size_t i = 0; i < m; i++)
+        for (size_t k = 0; k < n; k++)
+            a[i][k] = f32((i * 7 + k * 3) % 11) / 4.0f - 1.0f;
+    for (size_t k = 0; k < n; k++) {
+        x[k] = f32(k % 5) * 0.5f - 1.0f;
+        for (size_t j = 0; j < p; j++)
+            b[k][j] = f32((k + 2 * j) % 9) / 8.0f;
+    }
+    Matrix<f32> A(a), B(b);
+    Vector<f32> X(x);
+    Matrix<H> Ah = convert_matrix<H>(A), Bh = convert_matrix<H>(B);
+    Vector<H> Xh = convert_vector<H>(X);
+
+    Vector<f32> y = mul_vec(A, X);
+    Vector<f32> yh = mul_vec(Ah, Xh);
+    Vector<f32> ym = mul_vec(Ah, X);
+    for (size_t i = 0; i < m; i++) {
+        assert(almost_equal(y[i], yh[i], tol));
+        assert(almost_equal(y[i], ym[i], tol));
+    }
+
+    Matrix<f32> C = mul_mat(A, B);
+    Matrix<f32> Ch = mul_mat(Ah, Bh);
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < p; j++)
+            assert(almost_equal(C[i][j], Ch[i][j], tol));
+
+    assert(almost_equal(dot(X, X), dot(Xh, Xh), tol));
+}
+
+void test_half_kernels() {
+    std::cout << "Testing f16/bf16 mul_vec, mul_mat and dot..." << std::endl;
+
+    // The test values are exact in f16 and bf16, so only summation order differs
+    check_half_kernels<f16>(1e-4f);
+    check_half_kernels<bf16>(1e-4f);
+
+    std::cout << "f16/bf16 kernel tests passed!" << std::endl;
+}
+
+void test_int8_kernels() {
+    std::cout << "Testing int8 mul_vec and mul_mat..." << std::endl;
+
+    // Full int8 range including -128, long enough for the SIMD paths and a tail
+    size_t m = 7, n = 131, p = 5;
+    std::vector<std::vector<int8_t>> a(m, std::vector<int8_t>(n)), b(n, std::vector<int8_t>(p));
+    std::vector<int8_t> x(n);
+    for (size_t i = 0; i < m; i++)
+        for (size_t k = 0; k < n; k++)
+            a[i][k] = int8_t((i * 37 + k * 101) % 256 - 128);
+    for (size_t k = 0; k < n; k++) {
+        x[k] = k % 3 ? int8_t(-128) : int8_t(127);
+        for (size_t j = 0; j < p; j++)
+            b[k][j] = int8_t((k * 53 + j * 17) % 256 - 128);
+    }
+    Matrix<int8_t> A(a), B(b);
+
+    // int8 accumulation would wrap: the sums reach millions
+    Vector<int32_t> y = mul_vec(A, Vector<int8_t>(x));
+    for (size_t i = 0; i < m; i++) {
+        int32_t expected = 0;
+        for (size_t k = 0; k < n; k++)
+            expected += int32_t(a[i][k]) * int32_t(x[k]);
+        assert(y[i] == expected);
+    }
+
+    Matrix<int32_t> C = mul_mat(A, B);
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < p; j++) {
+            int32_t expected = 0;
+            for (size_t k = 0; k < n; k++)
+                expected += int32_t(a[i][k]) * int32_t(b[k][j]);
+            assert(C[i][j] == expected);
+        }
+
+    std::cout << "int8 kernel tests passed!" << std::endl;
+}
+
+void test_quantized_kernels() {
+    std::cout << "Testing quantized mul_vec and mul_mat..." << std::endl;
+
+    size_t m = 9, n = 100, p = 6;
+    std::vector<std::vector<f32>> a(m, std::vector<f32>(n)), b(n, std::vector<f32>(p));
+    std::vector<f32> x(n);
+    for (size_t i = 0; i < m; i++)
+        for (size_t k = 0; k < n; k++)
+            a[i][k] = std::sin(f32(i * n + k)) * f32(i + 1);   // rows with different ranges
+    for (size_t k = 0; k < n; k++) {
+        x[k] = std::cos(f32(k) * 0.7f);
+        for (size_t j = 0; j < p; j++)
+            b[k][j] = std::cos(f32(k * p + j));
+    }
+    Matrix<f32> A(a), B(b);
+    Vector<f32> X(x);
+
+    QuantizedMatrix qa = quantize_rows(A);
+    assert(qa.scales.size() == m);
+    for (size_t i = 0; i < m; i++)
+        for (size_t k = 0; k < n; k++)
+            assert(std::fabs(f32(qa.values[i][k]) * qa.scales[i] - a[i][k]) <= qa.scales[i] * 0.5f + 1e-6f);
+
+    // Each product carries at most ~1% relative error per operand
+    Vector<f32> y = mul_vec(A, X);
+    Vector<f32> yq = mul_vec(qa, quantize(X));
+    for (size_t i = 0; i < m; i++)
+        assert(std::fabs(y[i] - yq[i]) < 0.02f * f32(n) * f32(i + 1) * 0.1f + 0.05f);
+
+    Matrix<f32> C = mul_mat(A, B);
+    Matrix<f32> Cq = mul_mat_transposed(qa, quantize_cols(B));
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < p; j++)
+            assert(std::fabs(C[i][j] - Cq[i][j]) < 0.02f * f32(n) * f32(i + 1) * 0.1f + 0.05f);
+
+    std::cout << "Quantized kernel tests passed!" << std::endl;
+}
+
+// Matrix with small deterministic entries, multiples of 1/divisor
+template <typename K>
+Matrix<K> test_matrix(size_t rows, size_t cols, size_t seed, K divisor = K(4)) {
+    std::vector<std::vector<K>> data(rows, std::vector<K>(cols));
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            data[i][j] = K(int((i * 31 + j * 17 + seed * 7) % 19) - 9) / divisor;
+    return Matrix<K>(data);
+}
+
+void test_strassen() {
+    std::cout << "Testing Strassen-Winograd mul_mat..." << std::endl;
+
+    // Odd size: 75 -> 38 -> 19 -> 10 with crossover 10, padded to 80
+    Matrix<f32> A = test_matrix<f32>(75, 75, 1, 7.0f);
+    Matrix<f32> B = test_matrix<f32>(75, 75, 2, 3.0f);
+    Matrix<f32> ref = mul_mat(A, B);
+    MulInfo<f32> classical;
+    MulInfo<f32> strassen;
+    Matrix<f32> C = mul_mat(A, B, MulMode::Classical, 10, &classical);
+    Matrix<f32> S = mul_mat(A, B, MulMode::Strassen, 10, &strassen);
+    assert(classical.levels == 0 && strassen.levels == 3 && strassen.padded_size == 80);
+    assert(strassen.error_bound > classical.error_bound);
+    f32 max_err = 0;
+    for (size_t i = 0; i < 75; ++i)
+        for (size_t j = 0; j < 75; ++j) {
+            assert(std::fabs(C[i][j] - ref[i][j]) <= classical.error_bound);
+            max_err = std::fmax(max_err, std::fabs(S[i][j] - ref[i][j]));
+        }
+    assert(max_err <= strassen.error_bound);
+    std::cout << "Strassen error " << max_err << " <= bound " << strassen.error_bound << std::endl;
+
+    // Quarters are exact in double, so every schedule step can be checked exactly
+    Matrix<double> Ad = test_matrix<double>(64, 64, 3);
+    Matrix<double> Bd = test_matrix<double>(64, 64, 4);
+    assert(mul_mat(Ad, Bd, MulMode::Strassen, 4) == mul_mat(Ad, Bd));
+
+    // Rectangular or small products fall back to the classical kernel
+    MulInfo<double> info;
+    Matrix<double> R = mul_mat(test_matrix<double>(5, 7, 1), test_matrix<double>(7, 3, 2), MulMode::Strassen, 2, &info);
+    assert(info.levels == 0 && R == mul_mat(test_matrix<double>(5, 7, 1), test_matrix<double>(7, 3, 2)));
+
+    bool thrown = false;
+    try {
+        mul_mat(A, test_matrix<f32>(3, 3, 0), MulMode::Strassen);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Strassen tests passed!" << std::endl;
+}
+
+// max |M - N| over all elements
+double max_diff(const Matrix<double>& M, const Matrix<double>& N) {
+    double diff = 0;
+    for (size_t i = 0; i < M.getRows(); ++i)
+        for (size_t j = 0; j < M.getCols(); ++j)
+            diff = std::fmax(diff, std::fabs(M[i][j] - N[i][j]));
+    return diff;
+}
+
+void test_gemm() {
+    std::cout << "Testing in-place gemm and gemv..." << std::endl;
+
+    // 6x9 times 9x5 in every transpose combination, C ← 2·op(A)·op(B) - 0.5·C
+    Matrix<double> A = test_matrix<double>(6, 9, 1, 3.0);
+    Matrix<double> B = test_matrix<double>(9, 5, 2, 5.0);
+    Matrix<double> C0 = test_matrix<double>(6, 5, 3, 2.0);
+    Matrix<double> expected = mul_mat(A, B) * 2.0 + C0 * -0.5;
+    Matrix<double> At = transpose(A);
+    Matrix<double> Bt = transpose(B);
+    Op ops[] = {Op::NoTrans, Op::Trans};
+    for (Op op_a : ops)
+        for (Op op_b : ops) {
+            Matrix<double> C(C0);
+            gemm(2.0, op_a == Op::NoTrans ? A : At, op_b == Op::NoTrans ? B : Bt, -0.5, C, op_a, op_b, 2);
+            assert(max_diff(C, expected) < 1e-12);
+        }
+
+    // beta = 0 overwrites C, even NaN, and an empty C is allocated
+    Matrix<double> N(std::vector<std::vector<double>>(6, std::vector<double>(5, std::nan(""))));
+    gemm(1.0, A, B, 0.0, N);
+    assert(max_diff(N, mul_mat(A, B)) < 1e-12);
+    Matrix<double> E;
+    gemm(1.0, A, B, 0.0, E);
+    assert(E.getRows() == 6 && E.getCols() == 5 && max_diff(E, mul_mat(A, B)) < 1e-12);
+
+    // gemv: y ← 3·A·x + 2·y, then y ← Aᵀ·z
+    Vector<double> x({1, -2, 0.5, 3, -1, 2, 0, 1, -0.5});
+    Vector<double> y({1, 2, 3, 4, 5, 6});
+    Vector<double> ref = mul_vec(A, x) * 3.0 + y * 2.0;
+    gemv(3.0, A, x, 2.0, y);
+    for (size_t i = 0; i < 6; ++i)
+        assert(std::fabs(y[i] - ref[i]) < 1e-12);
+    Vector<double> z;
+    gemv(1.0, A, y, 0.0, z, Op::Trans);
+    Vector<double> zref = mul_vec(At, y);
+    assert(z.getSize() == 9);
+    for (size_t i = 0; i < 9; ++i)
+        assert(std::fabs(z[i] - zref[i]) < 1e-10);
+
+    bool thrown = false;
+    try {
+        gemm(1.0, A, A, 0.0, E);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "gemm/gemv tests passed!" << std::endl;
+}
+
+void test_syrk() {
+    std::cout << "Testing syrk and gram..." << std::endl;
+
+    Matrix<double> A = test_matrix<double>(11, 7, 4, 3.0);
+    Matrix<double> AtA = mul_mat(transpose(A), A);
+    Matrix<double> AAt = mul_mat(A, transpose(A));
+    assert(max_diff(gram(A, true, 3), AtA) < 1e-12);
+
+    Matrix<double> upper = gram(A, false);
+    for (size_t i = 0; i < 7; ++i)
+        for (size_t j = 0; j < 7; ++j)
+            assert(j < i ? upper[i][j] == 0 : std::fabs(upper[i][j] - AtA[i][j]) < 1e-12);
+
+    // Lower triangle of 2·A·Aᵀ + C, the upper triangle keeps its old values
+    Matrix<double> C0 = test_matrix<double>(11, 11, 5, 2.0);
+    Matrix<double> C(C0);
+    syrk(2.0, A, 1.0, C, Triangle::Lower, Op::NoTrans, 2);
+    for (size_t i = 0; i < 11; ++i)
+        for (size_t j = 0; j < 11; ++j)
+            assert(j > i ? C[i][j] == C0[i][j] : std::fabs(C[i][j] - (2 * AAt[i][j] + C0[i][j])) < 1e-12);
+    mirror_triangle(C, Triangle::Lower);
+    assert(C == transpose(C));
+    std::cout << "syrk/gram tests passed!" << std::endl;
+}
+
+void test_packed() {
+    std::cout << "Testing packed symmetric and triangular storage..." << std::endl;
+
+    const size_t n = 9;
+    Matrix<double> A = test_matrix<double>(n + 3, n, 6, 3.0);
+    Matrix<double> spd = gram(A);
+    for (size_t i = 0; i < n; ++i)
+        spd[i][i] += 1.0;
+    Vector<double> x({1, -2, 0.5, 3, -1, 2, 0, 1.5, -0.25});
+    Vector<double> expected = mul_vec(spd, x);
+
+    for (Triangle uplo : {Triangle::Upper, Triangle::Lower}) {
+        PackedSymmetric<double> S = PackedSymmetric<double>::from_dense(spd, uplo);
+        assert(S.packed().size() == n * (n + 1) / 2);
+        assert(S.to_dense() == spd);
+        Vector<double> y = mul_vec(S, x);
+        Vector<double> solved = solve(S, expected);
+        for (size_t i = 0; i < n; ++i) {
+            assert(std::fabs(y[i] - expected[i]) < 1e-12);
+            assert(std::fabs(solved[i] - x[i]) < 1e-10);
+        }
+
+        for (Diag diag : {Diag::NonUnit, Diag::Unit}) {
+            PackedTriangular<double> T = PackedTriangular<double>::from_dense(spd, uplo, diag);
+            Matrix<double> dense = T.to_dense();
+            Vector<double> Tx = mul_vec(T, x);
+            Vector<double> dense_Tx = mul_vec(dense, x);
+            for (size_t i = 0; i < n; ++i)
+                assert(std::fabs(Tx[i] - dense_Tx[i]) < 1e-12);
+            for (Op op : {Op::NoTrans, Op::Trans}) {
+                // A unit diagonal makes T badly conditioned: compare with the dense solve
+                Vector<double> b = mul_vec(op == Op::NoTrans ? dense : transpose(dense), x);
+                Vector<double> dense_b(b);
+                trsv(T, b, op);
+                trsv(spd, dense_b, uplo, op, diag);
+                for (size_t i = 0; i < n; ++i)
+                    assert(std::fabs(b[i] - dense_b[i]) <= 1e-12 * (1 + std::fabs(dense_b[i])));
+                if (diag == Diag::NonUnit)
+                    for (size_t i = 0; i < n; ++i)
+                        assert(std::fabs(b[i] - x[i]) < 1e-10);
+            }
+        }
+    }
+
+    // Packed Cholesky factor matches the packed product UᵀU
+    PackedTriangular<double> U = cholesky(PackedSymmetric<double>::from_dense(spd));
+    Matrix<double> Ud = U.to_dense();
+    assert(max_diff(mul_mat(transpose(Ud), Ud), spd) < 1e-10);
+    bool thrown = false;
+    try {
+        cholesky(PackedSymmetric<double>::from_dense(Matrix<double>({{1, 2}, {2, 1}})));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Hermitian: the mirrored triangle reads conjugated
+    using c64 = std::complex<double>;
+    Matrix<c64> H({{c64(4, 0), c64(1, 2), c64(0, -1)},
+                   {c64(1, -2), c64(6, 0), c64(2, 1)},
+                   {c64(0, 1), c64(2, -1), c64(5, 0)}});
+    Vector<c64> z({c64(1, 1), c64(-2, 0), c64(0, 3)});
+    Vector<c64> Hz = mul_vec(H, z);
+    for (Triangle uplo : {Triangle::Upper, Triangle::Lower}) {
+        PackedSymmetric<c64> S = PackedSymmetric<c64>::from_dense(H, uplo);
+        Vector<c64> y = mul_vec(S, z);
+        Vector<c64> solved = solve(S, Hz);
+        for (size_t i = 0; i < 3; ++i) {
+            assert(std::abs(y[i] - Hz[i]) < 1e-12);
+            assert(std::abs(solved[i] - z[i]) < 1e-12);
+        }
+    }
+    std::cout << "Packed storage tests passed!" << std::endl;
+}
+
+void test_multiply_chain() {
+    std::cout << "Testing multiply_chain..." << std::endl;
+
+    // Textbook example (CLRS 15.2): 15125 scalar multiplications
+    ChainPlan plan = plan_chain({30, 35, 15, 5, 10, 20, 25});
+    assert(plan.order == "((A0·(A1·A2))·((A3·A4)·A5))");
+    assert(plan.flops == 2 * 15125.0);
+    assert(plan.naive_flops > plan.flops);
+
+    Matrix<double> A = test_matrix<double>(10, 40, 1);
+    Matrix<double> B = test_matrix<double>(40, 3, 2);
+    Matrix<double> C = test_matrix<double>(3, 50, 3);
+    Matrix<double> D = test_matrix<double>(50, 2, 4);
+    Matrix<double> expected = mul_mat(mul_mat(mul_mat(A, B), C), D);
+    Matrix<double> R = multiply_chain<double>({A, B, C, D}, &plan, 2);
+    assert(R.getRows() == 10 && R.getCols() == 2);
+    assert(max_diff(R, expected) < 1e-9);
+    assert(plan.order == "(A0·(A1·(A2·A3)))");
+    assert(plan.flops == 2.0 * (3 * 50 * 2 + 40 * 3 * 2 + 10 * 40 * 2));
+    assert(plan.naive_flops == 2.0 * (10 * 40 * 3 + 10 * 3 * 50 + 10 * 50 * 2));
+
+    // Outer product first would be the worst order here
+    Matrix<double> u = test_matrix<double>(60, 1, 5);
+    Matrix<double> v = test_matrix<double>(1, 60, 6);
+    Matrix<double> w = test_matrix<double>(60, 1, 7);
+    R = multiply_chain<double>({u, v, w}, &plan);
+    assert(plan.order == "(A0·(A1·A2))");
+    assert(max_diff(R, mul_mat(u, mul_mat(v, w))) < 1e-12);
+
+    assert(multiply_chain<double>({A}) == A);
+    bool thrown = false;
+    try {
+        multiply_chain<double>({A, C});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "multiply_chain tests passed!" << std::endl;
+}
+
 int main() {
     std::cout << "Running matrix operation tests..." << std::endl;
 
@@ -152,6 +552,33 @@ int main() {
     
     test_mul_mat_member();
     std::cout << "==========" << std::endl;
+
+    test_half_conversions();
+    std::cout << "==========" << std::endl;
+
+    test_half_kernels();
+    std::cout << "==========" << std::endl;
+
+    test_int8_kernels();
+    std::cout << "==========" << std::endl;
+
+    test_quantized_kernels();
+    std::cout << "==========" << std::endl;
+
+    test_strassen();
+    std::cout << "==========" << std::endl;
+
+    test_gemm();
+    std::cout << "==========" << std::endl;
+
+    test_syrk();
+    std::cout << "==========" << std::endl;
+
+    test_packed();
+    std::cout << "==========" << std::endl;
+
+    test_multiply_chain();
+    std::cout << "==========" << std::endl;
     
     std::cout << "✅ All unit tests passed!\n";
     return 0;
@@ -1,7 +1,11 @@
+#include "../includes/linalg.hpp"
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include <cmath>
+#include <complex>
 #include <iostream>
+#include <limits>
 #include <cassert>
 #include <sys/types.h>
 
@@ -164,12 +168,106 @@ void test_special_cases() {
     std::cout << "Special case tests passed!" << std::endl;
 }
 
+void test_slogdet() {
+    std::cout << "Testing slogdet..." << std::endl;
+
+    // Agrees with determinant() on small matrices
+    Matrix<double> small({{2, -1, 0, 3}, {1, 4, -2, 0}, {0, 1, 5, 1}, {-3, 0, 2, 1}});
+    SlogDet<double> sd = slogdet(small);
+    double det = small.determinant();
+    assert(sd.sign == (det > 0 ? 1.0 : -1.0));
+    assert(std::fabs(std::exp(sd.logabs) - std::fabs(det)) < 1e-9 * std::fabs(det));
+
+    // det = 1000^200 overflows f32 (and f64), the log does not
+    const size_t n = 200;
+    std::vector<std::vector<f32>> t(n, std::vector<f32>(n));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = i; j < n; ++j)
+            t[i][j] = i == j ? (i % 7 == 3 ? -1000.0f : 1000.0f) : f32(int((i + 2 * j) % 5) - 2);
+    SlogDet<f32> big = slogdet(Matrix<f32>(t), 2);
+    double expected = double(n) * std::log(1000.0);
+    assert(std::fabs(double(big.logabs) - expected) < 1e-5 * expected);
+    size_t negatives = (n + 3) / 7;
+    assert(big.sign == (negatives % 2 ? -1.0f : 1.0f));
+    std::swap(t[0], t[1]);
+    assert(slogdet(Matrix<f32>(t)).sign == -big.sign);
+
+    // Blocked elimination (n > LU_BLOCK): same logdet through LU and Cholesky
+    const size_t m = 150;
+    Matrix<double> A(std::vector<std::vector<double>>(m, std::vector<double>(m)));
+    for (size_t i = 0; i < m; ++i)
+        for (size_t j = 0; j < m; ++j)
+            A[i][j] = std::sin(double(i * m + j)) + (i == j ? 0.1 : 0.0);
+    LU<double> lu(A, 3);
+    Vector<double> x{std::vector<double>(m, 1.0)};
+    Vector<double> b = mul_vec(A, x);
+    Vector<double> solved = lu.solve(b);
+    for (size_t i = 0; i < m; ++i)
+        assert(std::fabs(solved[i] - 1.0) < 1e-8);
+    Matrix<double> spd = mul_mat(transpose(A), A);
+    SlogDet<double> via_lu = LU<double>(spd).slogdet();
+    SlogDet<double> via_chol = Cholesky<double>(spd).slogdet();
+    SlogDet<double> via_a = lu.slogdet();
+    assert(via_lu.sign == 1 && via_chol.sign == 1);
+    assert(std::fabs(via_lu.logabs - via_chol.logabs) < 1e-8 * std::fabs(via_chol.logabs));
+    assert(std::fabs(via_chol.logabs - 2 * via_a.logabs) < 1e-8 * std::fabs(via_chol.logabs));
+
+    // A uniformly tiny matrix is well conditioned: the tolerance follows its scale
+    std::vector<std::vector<f32>> tiny(50, std::vector<f32>(50));
+    for (size_t i = 0; i < 50; ++i)
+        tiny[i][i] = 1e-11f;
+    SlogDet<f32> small_det = slogdet(Matrix<f32>(tiny));
+    assert(small_det.sign == 1.0f);
+    assert(std::fabs(double(small_det.logabs) - 50 * std::log(double(1e-11f))) < 1e-3);
+    Matrix<double> scaled(A);
+    for (size_t i = 0; i < m; ++i)
+        for (size_t j = 0; j < m; ++j)
+            scaled[i][j] *= 1e-12;
+    SlogDet<double> via_scaled = slogdet(scaled);
+    assert(via_scaled.sign == via_a.sign);
+    assert(std::fabs(via_scaled.logabs - (via_a.logabs + double(m) * std::log(1e-12)))
+           < 1e-8 * std::fabs(via_scaled.logabs));
+    assert(slogdet(Matrix<double>({{1e-12, 2e-12}, {2e-12, 4e-12}})).sign == 0);
+
+    SlogDet<f32> singular = slogdet(Matrix<f32>({{1, 2}, {2, 4}}));
+    assert(singular.sign == 0 && singular.logabs == -std::numeric_limits<f32>::infinity());
+    std::cout << "slogdet tests passed!" << std::endl;
+}
+
+void test_4x4_closed_form() {
+    std::cout << "Testing closed-form 4x4 determinants..." << std::endl;
+
+    // Same value through the float kernel, the double one and LU
+    for (int seed = 1; seed <= 20; ++seed) {
+        std::vector<std::vector<double>> d(4, std::vector<double>(4));
+        std::vector<std::vector<f32>> f(4, std::vector<f32>(4));
+        for (size_t i = 0; i < 4; ++i)
+            for (size_t j = 0; j < 4; ++j) {
+                d[i][j] = double(int((seed * 37 + i * 11 + j * 7 + i * j * seed) % 19) - 9);
+                f[i][j] = f32(d[i][j]);
+            }
+        Matrix<double> A(d);
+        double det = A.determinant();
+        SlogDet<double> sd = slogdet(A);
+        assert(std::fabs(sd.sign * std::exp(sd.logabs) - det) < 1e-9 * (1 + std::fabs(det)));
+        // Integer entries below 10: every intermediate is exact in f32
+        assert(double(Matrix<f32>(f).determinant()) == det);
+    }
+
+    // Complex entries use the scalar formula
+    using C = std::complex<double>;
+    Matrix<C> Z({{C(1, 1), 0, 0, 0}, {0, C(0, 2), 0, 0}, {0, 0, 3, 0}, {C(5, -1), 7, 0, 1}});
+    assert(std::abs(Z.determinant() - C(1, 1) * C(0, 2) * 3.0) < 1e-12);
+    std::cout << "Closed-form 4x4 determinant tests passed!" << std::endl;
+}
 
 int main() {
     test_2x2_determinants();
     test_3x3_determinants();
     test_4x4_determinants();
+    test_4x4_closed_form();
     test_special_cases();
+    test_slogdet();
     
     std::cout << "✅ All unit tests passed!\n";
     return 0;
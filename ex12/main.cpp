@@ -1,6 +1,10 @@
+#include "../includes/banded.hpp"
 #include "../includes/vector.hpp"
 #include "../includes/matrix.hpp"
 #include "../includes/utils.hpp"
+#include "../includes/solvers.hpp"
+#include "../includes/structured.hpp"
+#include "../includes/linalg.hpp"
 #include <cassert>
 
 // Helper function to check if two matrices are approximately equal
@@ -181,6 +185,723 @@ void test_methods()
 
 }
 
+// Helper building the n x n 1D Poisson matrix tridiag(-1, 2, -1), optionally
+// made non-symmetric with a convection term on the upper diagonal
+Matrix<f32> create_poisson(size_t n, f32 convection = 0.0f) {
+    std::vector<std::vector<f32>> data(n, std::vector<f32>(n, 0.0f));
+    for (size_t i = 0; i < n; i++) {
+        data[i][i] = 2.0f;
+        if (i > 0)
+            data[i][i - 1] = -1.0f;
+        if (i + 1 < n)
+            data[i][i + 1] = -1.0f + convection;
+    }
+    return Matrix<f32>{data};
+}
+
+// Helper checking ||b - A·x|| / ||b|| against a tolerance
+bool solves_system(const Matrix<f32>& A, const Vector<f32>& x, const Vector<f32>& b, f32 tol = 1e-4f) {
+    Vector<f32> r = b - mul_vec(A, x);
+    return norm(r) <= tol * norm(b);
+}
+
+void test_krylov_solvers() {
+    std::cout << "Testing Krylov solvers..." << std::endl;
+
+    size_t n = 40;
+    Matrix<f32> spd = create_poisson(n);
+    Matrix<f32> nonsym = create_poisson(n, 0.5f);
+    Vector<f32> b(std::vector<f32>(n, 1.0f));
+    SolverOptions<f32> opts;
+    opts.tol = 1e-6f;
+
+    Vector<f32> x(std::vector<f32>(n, 0.0f));
+    SolverResult<f32> res = cg(spd, b, x, opts);
+    assert(res.converged);
+    assert(res.residuals.size() == res.iterations + 1);
+    assert(solves_system(spd, x, b));
+
+    // Same workspace reused for several solves of the same size
+    KrylovWorkspace<f32> ws;
+    JacobiPreconditioner<f32> jacobi(nonsym);
+    ILU0Preconditioner<f32> ilu(nonsym);
+
+    x = Vector<f32>(std::vector<f32>(n, 0.0f));
+    res = gmres(nonsym, b, x, IdentityPreconditioner<f32>(), ws, opts);
+    assert(res.converged);
+    assert(solves_system(nonsym, x, b));
+
+    x = Vector<f32>(std::vector<f32>(n, 0.0f));
+    res = bicgstab(nonsym, b, x, jacobi, ws, opts);
+    assert(res.converged);
+    assert(solves_system(nonsym, x, b));
+
+    // ILU(0) of a tridiagonal matrix is its exact LU, so GMRES converges at once
+    x = Vector<f32>(std::vector<f32>(n, 0.0f));
+    res = gmres(nonsym, b, x, ilu, ws, opts);
+    assert(res.converged);
+    assert(res.iterations <= 2);
+    assert(solves_system(nonsym, x, b));
+
+    ILU0Preconditioner<f32> spd_ilu(spd);
+    x = Vector<f32>(std::vector<f32>(n, 0.0f));
+    res = cg(spd, b, x, spd_ilu, ws, opts);
+    assert(res.converged);
+    assert(res.iterations <= 2);
+    assert(solves_system(spd, x, b));
+
+    std::cout << "Krylov solver tests passed!" << std::endl;
+}
+
+void test_mixed_precision() {
+    std::cout << "Testing mixed precision solve and inverse..." << std::endl;
+
+    size_t n = 30;
+    std::vector<std::vector<double>> data(n, std::vector<double>(n));
+    std::vector<double> rhs(n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++)
+            data[i][j] = 1.0 / double(1 + i + 2 * j % 7) + (i == j ? double(n) : 0.0);
+        rhs[i] = double(i % 5) - 2.0;
+    }
+    Matrix<double> A(data);
+    Vector<double> b(rhs);
+
+    // A float factorisation alone gives ~1e-7, refinement must reach double accuracy
+    Vector<double> x;
+    RefinementInfo<double> info = solve(A, b, x, SolveMode::MixedPrecision);
+    assert(info.status == RefinementStatus::Converged);
+    assert(info.iterations > 0);
+    assert(info.backward_error < 1e-14);
+    assert(norm(b - mul_vec(A, x)) < 1e-12);
+
+    Vector<double> direct;
+    info = solve(A, b, direct, SolveMode::Direct);
+    assert(info.status == RefinementStatus::Direct);
+    assert(norm(x - direct) < 1e-12);
+
+    RefinementInfo<double> inv_info;
+    Matrix<double> A_inv = inverse(A, SolveMode::MixedPrecision, &inv_info);
+    assert(inv_info.status == RefinementStatus::Converged);
+    Matrix<double> product = mul_mat(A, A_inv);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            assert(std::abs(product[i][j] - (i == j ? 1.0 : 0.0)) < 1e-12);
+
+    // 1 + 1e-8 rounds to 1 in float: singular in float, fine in double
+    Matrix<double> near_singular({
+        {1, 1, 0},
+        {1, 1 + 1e-8, 0},
+        {0, 0, 2}
+    });
+    Vector<double> ones(std::vector<double>(3, 1.0));
+    info = solve(near_singular, ones, x, SolveMode::MixedPrecision);
+    assert(info.status == RefinementStatus::FellBack);
+    assert(info.backward_error < 1e-14);
+
+    std::cout << "Mixed precision tests passed!" << std::endl;
+}
+
+// Dense op(T) with the ignored triangle zeroed and, for Unit, ones on the diagonal
+Matrix<double> explicit_triangle(const Matrix<double>& T, Triangle uplo, Op op, Diag diag) {
+    size_t n = T.getRows();
+    Matrix<double> R(std::vector<std::vector<double>>(n, std::vector<double>(n)));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j) {
+            bool inside = uplo == Triangle::Upper ? j >= i : j <= i;
+            if (inside)
+                R[i][j] = (i == j && diag == Diag::Unit) ? 1.0 : T[i][j];
+        }
+    return op == Op::NoTrans ? R : transpose(R);
+}
+
+void test_triangular_kernels() {
+    std::cout << "Testing trsv, trsm and trmm..." << std::endl;
+
+    const size_t n = 9;
+    const size_t cols = 6;
+    std::vector<std::vector<double>> t(n, std::vector<double>(n));
+    std::vector<std::vector<double>> b(n, std::vector<double>(cols));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j)
+            t[i][j] = i == j ? 4.0 + double(i % 3) : double(int((i * 5 + j * 3) % 7) - 3) / 4.0;
+        for (size_t j = 0; j < cols; ++j)
+            b[i][j] = double(int((i * 2 + j * 7) % 11) - 5);
+    }
+    Matrix<double> T(t);
+    Matrix<double> B(b);
+
+    for (Triangle uplo : {Triangle::Upper, Triangle::Lower})
+        for (Op op : {Op::NoTrans, Op::Trans})
+            for (Diag diag : {Diag::NonUnit, Diag::Unit}) {
+                Matrix<double> dense = explicit_triangle(T, uplo, op, diag);
+
+                // trmm matches the dense product, trsm undoes it
+                Matrix<double> X(B);
+                trmm(2.0, T, X, uplo, op, diag, 2);
+                Matrix<double> expected = mul_mat(dense, B) * 2.0;
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < cols; ++j)
+                        assert(std::fabs(X[i][j] - expected[i][j]) < 1e-10);
+                trsm(0.5, T, X, uplo, op, diag, 2);
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < cols; ++j)
+                        assert(std::fabs(X[i][j] - B[i][j]) < 1e-10);
+
+                // trsv solves one column
+                Vector<double> x({1, -2, 3, 0.5, -1, 2, 4, -3, 1});
+                Vector<double> rhs = mul_vec(dense, x);
+                trsv(T, rhs, uplo, op, diag);
+                for (size_t i = 0; i < n; ++i)
+                    assert(std::fabs(rhs[i] - x[i]) < 1e-10);
+            }
+
+    Matrix<double> S({{1, 2}, {0, 0}});
+    Vector<double> v({1, 1});
+    bool thrown = false;
+    try {
+        trsv(S, v, Triangle::Upper);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    trsv(S, v, Triangle::Upper, Op::NoTrans, Diag::Unit);
+    assert(v[0] == -1 && v[1] == 1);
+    std::cout << "Triangular kernel tests passed!" << std::endl;
+}
+
+double max_abs_diff(const Matrix<double>& A, const Matrix<double>& B) {
+    double res = 0;
+    for (size_t i = 0; i < A.getRows(); ++i)
+        for (size_t j = 0; j < A.getCols(); ++j)
+            res = std::max(res, std::fabs(A[i][j] - B[i][j]));
+    return res;
+}
+
+void test_pow_expm() {
+    std::cout << "Testing pow and expm..." << std::endl;
+
+    Matrix<double> F({{1, 1}, {1, 0}});
+    Matrix<double> F10 = pow(F, 10);
+    assert(F10[0][0] == 89 && F10[0][1] == 55 && F10[1][0] == 55 && F10[1][1] == 34);
+    Matrix<double> F0 = pow(F, 0);
+    assert(F0[0][0] == 1 && F0[0][1] == 0 && F0[1][0] == 0 && F0[1][1] == 1);
+
+    Matrix<double> A({{0.5, -0.25, 0.125}, {0.25, 0.75, -0.5}, {-0.125, 0.5, 0.25}});
+    Matrix<double> repeated(A);
+    for (size_t k = 1; k < 13; ++k)
+        repeated = mul_mat(repeated, A);
+    assert(max_abs_diff(pow(A, 13), repeated) < 1e-12);
+    assert(max_abs_diff(pow(A, 1), A) == 0);
+
+    Matrix<double> zero({{0, 0}, {0, 0}});
+    assert(max_abs_diff(expm(zero), pow(F, 0)) == 0);
+    Matrix<double> nilpotent({{0, 1}, {0, 0}});
+    assert(max_abs_diff(expm(nilpotent), Matrix<double>({{1, 1}, {0, 1}})) < 1e-15);
+    Matrix<double> diag({{1, 0}, {0, -3}});
+    Matrix<double> expected({{std::exp(1.0), 0}, {0, std::exp(-3.0)}});
+    assert(max_abs_diff(expm(diag), expected) < 1e-13);
+
+    // Every Padé degree, and scaling and squaring for the large angles
+    for (double t : {0.01, 0.1, 0.5, 1.5, 4.0, 10.0, 50.0}) {
+        Matrix<double> rotation = expm(Matrix<double>({{0, -t}, {t, 0}}));
+        Matrix<double> exact({{std::cos(t), -std::sin(t)}, {std::sin(t), std::cos(t)}});
+        assert(max_abs_diff(rotation, exact) < 1e-13 * (1 + t));
+    }
+
+    Matrix<double> E = expm(A * 8.0);
+    Matrix<double> Einv = expm(A * -8.0);
+    assert(max_abs_diff(mul_mat(E, Einv), pow(A, 0)) < 1e-10);
+
+    Matrix<f32> Af({{0.5f, 1.0f}, {-1.0f, 0.5f}});
+    Matrix<f32> Ef = expm(Af);
+    Matrix<f32> expected_f({{std::exp(0.5f) * std::cos(1.0f), std::exp(0.5f) * std::sin(1.0f)},
+                            {-std::exp(0.5f) * std::sin(1.0f), std::exp(0.5f) * std::cos(1.0f)}});
+    assert(matrices_approximately_equal(Ef, expected_f));
+
+    bool thrown = false;
+    try {
+        expm(Matrix<double>({{1, 2, 3}, {4, 5, 6}}));
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "pow and expm tests passed!" << std::endl;
+}
+
+void test_banded() {
+    std::cout << "Testing banded and tridiagonal solvers..." << std::endl;
+
+    const size_t n = 40;
+    for (size_t lower : {0, 1, 3})
+        for (size_t upper : {0, 2}) {
+            BandMatrix<double> B(n, lower, upper);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = (i > lower ? i - lower : 0); j < std::min(n, i + upper + 1); ++j)
+                    B.at(i, j) = i == j ? (lower ? 0.5 : 5.0) + double(i % 4) / 8
+                                         : double(int((i * 7 + j * 3) % 9) - 4) / 2;
+            Matrix<double> dense = B.to_dense();
+            assert(max_abs_diff(BandMatrix<double>::from_dense(dense, lower, upper).to_dense(), dense) == 0);
+
+            Vector<double> x{std::vector<double>(n)};
+            for (size_t i = 0; i < n; ++i)
+                x[i] = std::sin(double(i));
+            Vector<double> b = mul_vec(B, x);
+            Vector<double> expected = mul_vec(dense, x);
+            for (size_t i = 0; i < n; ++i)
+                assert(std::fabs(b[i] - expected[i]) < 1e-12);
+
+            // With subdiagonals the diagonal is small, so solving relies on
+            // pivoting; the triangular cases are badly conditioned, so only
+            // their residual is checked
+            Vector<double> solved = BandLU<double>(B).solve(b);
+            Vector<double> check = mul_vec(B, solved);
+            for (size_t i = 0; i < n; ++i)
+                assert(std::fabs(check[i] - b[i]) < 1e-10);
+            if (lower && upper)
+                for (size_t i = 0; i < n; ++i)
+                    assert(std::fabs(solved[i] - x[i]) < 1e-10);
+        }
+
+    bool thrown = false;
+    try {
+        BandLU<double>(BandMatrix<double>(3, 1, 1));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 1D Poisson stencil, solved by Thomas and by a batch of shifted copies
+    BandMatrix<double> T(n, 1, 1);
+    for (size_t i = 0; i < n; ++i) {
+        T.at(i, i) = 2;
+        if (i > 0)
+            T.at(i, i - 1) = -1;
+        if (i + 1 < n)
+            T.at(i, i + 1) = -1;
+    }
+    Vector<double> rhs{std::vector<double>(n, 1.0)};
+    Vector<double> u = thomas_solve(T, rhs);
+    Vector<double> residual = mul_vec(T, u);
+    for (size_t i = 0; i < n; ++i)
+        assert(std::fabs(residual[i] - 1) < 1e-10);
+    assert(std::fabs(u[n / 2] - double(n / 2 + 1) * double(n - n / 2) / 2) < 1e-9);
+
+    const size_t count = 150;
+    TridiagonalBatch<double> batch(count, n);
+    std::vector<double> rhs_batch(count * n);
+    for (size_t s = 0; s < count; ++s)
+        for (size_t i = 0; i < n; ++i) {
+            batch.diag(s, i) = 2 + double(s) / 10;
+            batch.sub(s, i) = i > 0 ? -1 : 0;
+            batch.super(s, i) = i + 1 < n ? -1 : 0;
+            rhs_batch[i * count + s] = std::cos(double(i + s));
+        }
+    std::vector<double> solutions(rhs_batch);
+    batch.solve(solutions, 3);
+    for (size_t s = 0; s < count; s += 37) {
+        BandMatrix<double> Ts(n, 1, 1);
+        Vector<double> bs{std::vector<double>(n)};
+        for (size_t i = 0; i < n; ++i) {
+            Ts.at(i, i) = batch.diag(s, i);
+            if (i > 0)
+                Ts.at(i, i - 1) = batch.sub(s, i);
+            if (i + 1 < n)
+                Ts.at(i, i + 1) = batch.super(s, i);
+            bs[i] = rhs_batch[i * count + s];
+        }
+        Vector<double> xs = thomas_solve(Ts, bs);
+        for (size_t i = 0; i < n; ++i)
+            assert(std::fabs(xs[i] - solutions[i * count + s]) < 1e-12);
+    }
+
+    // Singularity is relative to the scale of the band: 1e-11·T is fine
+    BandMatrix<double> tiny(T);
+    for (long d = -1; d <= 1; ++d)
+        for (size_t i = 0; i < n; ++i)
+            tiny.diagonal(d)[i] *= 1e-11;
+    Vector<double> tiny_u = thomas_solve(tiny, rhs);
+    Vector<double> tiny_lu = BandLU<double>(tiny).solve(rhs);
+    for (size_t i = 0; i < n; ++i) {
+        assert(std::fabs(tiny_u[i] * 1e-11 - u[i]) < 1e-9);
+        assert(std::fabs(tiny_lu[i] * 1e-11 - u[i]) < 1e-9);
+    }
+    TridiagonalBatch<double> mixed(2, n);
+    std::vector<double> rhs_mixed(2 * n, 1.0);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t s = 0; s < 2; ++s) {
+            double scale = s == 0 ? 1e-11 : 1.0;
+            mixed.diag(s, i) = 2 * scale;
+            mixed.sub(s, i) = i > 0 ? -scale : 0;
+            mixed.super(s, i) = i + 1 < n ? -scale : 0;
+        }
+    mixed.solve(rhs_mixed, 1);
+    for (size_t i = 0; i < n; ++i) {
+        assert(std::fabs(rhs_mixed[2 * i] * 1e-11 - u[i]) < 1e-9);
+        assert(std::fabs(rhs_mixed[2 * i + 1] - u[i]) < 1e-9);
+    }
+
+    // A BandMatrix is a Krylov operator
+    SolverOptions<double> opts;
+    opts.tol = 1e-12;
+    Vector<double> cg_x{std::vector<double>(n)};
+    SolverResult<double> res = cg(T, rhs, cg_x, opts);
+    assert(res.converged);
+    for (size_t i = 0; i < n; ++i)
+        assert(std::fabs(cg_x[i] - u[i]) < 1e-8);
+    std::cout << "Banded solver tests passed!" << std::endl;
+}
+
+void test_structured() {
+    std::cout << "Testing identity, diagonal and permutation matrices..." << std::endl;
+
+    Matrix<double> M({{1, 2, 3}, {4, 5, 6}, {7, 8, 10}});
+    Identity I(3);
+    Diagonal<double> D({2, -1, 0.5});
+    Permutation P({2, 0, 1});
+    Vector<double> u({1, -2, 3});
+
+    assert(mul_mat(I, M) == M && mul_mat(M, I) == M);
+    assert(max_abs_diff(mul_mat(D, M), mul_mat(D.to_dense(), M)) == 0);
+    assert(max_abs_diff(mul_mat(M, D), mul_mat(M, D.to_dense())) == 0);
+    assert(max_abs_diff(mul_mat(P, M), mul_mat(P.to_dense<double>(), M)) == 0);
+    assert(max_abs_diff(mul_mat(M, P), mul_mat(M, P.to_dense<double>())) == 0);
+    assert(max_abs_diff(add(M, I), M + I.to_dense<double>()) == 0);
+    assert(max_abs_diff(add(D, M), M + D.to_dense()) == 0);
+
+    Vector<double> Du = mul_vec(D, u);
+    Vector<double> Pu = mul_vec(P, u);
+    Vector<double> Iu = mul_vec(I, u);
+    for (size_t i = 0; i < 3; ++i) {
+        assert(Du[i] == mul_vec(D.to_dense(), u)[i]);
+        assert(Pu[i] == mul_vec(P.to_dense<double>(), u)[i]);
+        assert(Iu[i] == u[i]);
+    }
+
+    // Structured results stay structured
+    Diagonal<double> DD = mul_mat(D, inverse(D));
+    Diagonal<double> sum = add(D, D);
+    for (size_t i = 0; i < 3; ++i) {
+        assert(DD[i] == 1);
+        assert(sum[i] == 2 * D[i]);
+    }
+    Permutation Q({1, 2, 0});
+    assert(mul_mat(P, Q).to_dense<double>() == mul_mat(P.to_dense<double>(), Q.to_dense<double>()));
+    assert(mul_mat(P, inverse(P)).indices() == Permutation(3).indices());
+    assert(inverse(I).size() == 3);
+
+    // Permutation parity matches the determinant of P
+    assert(P.sign() == 1 && Permutation({1, 0, 2}).sign() == -1);
+    Permutation S(4);
+    S.swap(0, 3);
+    S.swap(1, 2);
+    assert(S.sign() == 1 && Permutation(S.indices()).sign() == 1);
+
+    // The P of an LU factorisation
+    LU<double> lu(M);
+    Permutation LP(lu.permutation());
+    assert(LP.sign() == lu.sign());
+    Matrix<double> L = lu.factors();
+    Matrix<double> U = lu.factors();
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 3; ++j) {
+            L[i][j] = j < i ? L[i][j] : (i == j ? 1 : 0);
+            U[i][j] = j >= i ? U[i][j] : 0;
+        }
+    assert(max_abs_diff(mul_mat(LP, M), mul_mat(L, U)) < 1e-12);
+
+    bool thrown = false;
+    try {
+        inverse(Diagonal<double>(std::vector<double>{1, 0}));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    // The tolerance follows the scale of the diagonal
+    Diagonal<double> small(std::vector<double>{1e-11, -2e-11});
+    assert(std::fabs(inverse(small)[1] + 5e10) < 1e-3);
+    thrown = false;
+    try {
+        inverse(Diagonal<double>(std::vector<double>{1e-11, 1e-22}));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        Permutation({0, 0, 1});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        mul_mat(Identity(2), M);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Structured matrix tests passed!" << std::endl;
+}
+
+void test_inverse_updates() {
+    std::cout << "Testing Sherman-Morrison and Woodbury updates..." << std::endl;
+
+    const size_t n = 6;
+    std::vector<std::vector<double>> a(n, std::vector<double>(n));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            a[i][j] = i == j ? 5.0 + double(i) : double(int((i * 3 + j * 5) % 7) - 3) / 4;
+    Matrix<double> A(a);
+    Matrix<double> Ainv = inverse(A);
+
+    // A sequence of rank-1 ticks tracks the from-scratch inverse
+    Matrix<double> current(A);
+    for (size_t t = 0; t < 5; ++t) {
+        Vector<double> u{std::vector<double>(n)};
+        Vector<double> v{std::vector<double>(n)};
+        for (size_t i = 0; i < n; ++i) {
+            u[i] = std::sin(double(i + 3 * t));
+            v[i] = std::cos(double(2 * i + t)) / 2;
+        }
+        assert(inverse_update_rank1(Ainv, u, v));
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                current[i][j] += u[i] * v[j];
+        assert(max_abs_diff(Ainv, inverse(current)) < 1e-10);
+    }
+
+    // Rank-2 Woodbury update
+    Matrix<double> U({{1, 0}, {0, 1}, {0.5, -1}, {0, 0}, {2, 0}, {0, 0.25}});
+    Matrix<double> V({{0, 1}, {1, 0}, {0, 0}, {-0.5, 1}, {0, 0}, {1, 1}});
+    assert(inverse_update_woodbury(Ainv, U, V, 2));
+    current = add(current, mul_mat(U, transpose(V)));
+    assert(max_abs_diff(Ainv, inverse(current)) < 1e-10);
+
+    // Updates making the matrix singular are refused and leave the inverse as is
+    Matrix<double> I2({{1, 0}, {0, 1}});
+    Matrix<double> I2inv(I2);
+    assert(!inverse_update_rank1(I2inv, Vector<double>({1, 0}), Vector<double>({-1, 0})));
+    assert(I2inv == I2);
+    assert(!inverse_update_woodbury(I2inv, Matrix<double>({{1}, {0}}), Matrix<double>({{-1}, {0}})));
+    assert(I2inv == I2);
+    std::cout << "Inverse update tests passed!" << std::endl;
+}
+
+// P⁻¹·L·U rebuilt from an LU factorisation, to compare with the factorised matrix
+Matrix<double> lu_product(const LU<double>& lu) {
+    size_t n = lu.size();
+    const Matrix<double>& F = lu.factors();
+    Matrix<double> A(std::vector<std::vector<double>>(n, std::vector<double>(n)));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j) {
+            double sum = 0;
+            for (size_t c = 0; c <= std::min(i, j); ++c)
+                sum += (c == i ? 1.0 : F[i][c]) * F[c][j];
+            A[lu.permutation()[i]][j] = sum;
+        }
+    return A;
+}
+
+bool is_upper_trapezoidal(const Matrix<double>& R) {
+    for (size_t i = 0; i < R.getRows(); ++i)
+        for (size_t j = 0; j < std::min(i, R[i].size()); ++j)
+            if (std::fabs(R[i][j]) > 1e-12)
+                return false;
+    return true;
+}
+
+void check_qr(const QR<double>& qr, const Matrix<double>& A) {
+    assert(qr.rows() == A.getRows() && qr.cols() == A.getCols());
+    assert(is_upper_trapezoidal(qr.r()));
+    assert(max_abs_diff(mul_mat(qr.q(), qr.r()), A) < 1e-12);
+    assert(max_abs_diff(mul_mat(qr.qh(), qr.q()), Identity(A.getRows()).to_dense<double>()) < 1e-12);
+}
+
+void test_factor_updates() {
+    std::cout << "Testing factorisation updates..." << std::endl;
+
+    const size_t n = 6;
+    Matrix<double> B(std::vector<std::vector<double>>(n + 2, std::vector<double>(n)));
+    for (size_t i = 0; i < n + 2; ++i)
+        for (size_t j = 0; j < n; ++j)
+            B[i][j] = double(int((i * 5 + j * 3) % 11) - 5) / 3;
+    Matrix<double> spd = add(mul_mat(transpose(B), B), Identity(n));
+
+    // Cholesky: update, downdate back, refused downdate
+    Cholesky<double> chol(spd);
+    const Matrix<double>& L = chol.factor();
+    assert(max_abs_diff(mul_mat(L, transpose(L)), spd) < 1e-12);
+    Vector<double> x({1, -0.5, 2, 0, 1.5, -1});
+    Vector<double> b = mul_vec(spd, x);
+    Vector<double> solved = chol.solve(b);
+    for (size_t i = 0; i < n; ++i)
+        assert(std::fabs(solved[i] - x[i]) < 1e-10);
+    Matrix<double> updated(spd);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            updated[i][j] += x[i] * x[j];
+    chol.update(x);
+    assert(max_abs_diff(chol.factor(), Cholesky<double>(updated).factor()) < 1e-12);
+    chol.downdate(x);
+    assert(max_abs_diff(mul_mat(chol.factor(), transpose(chol.factor())), spd) < 1e-10);
+    Matrix<double> before = chol.factor();
+    bool thrown = false;
+    try {
+        chol.downdate(mul_vec(spd, Vector<double>({10, 0, 0, 0, 0, 0})));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && chol.factor() == before);
+
+    // LU: border by one row and column, then remove rows/columns
+    Matrix<double> M(std::vector<std::vector<double>>(n, std::vector<double>(n)));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            M[i][j] = B[i][j] + (i == j ? 2.0 : 0.0);
+    LU<double> lu(M);
+    Vector<double> row({1, 2, -1, 0.5, 0, 3});
+    Vector<double> col({0.5, -1, 1, 2, 0, 1});
+    lu.append(row, col, 4.0);
+    Matrix<double> grown(std::vector<std::vector<double>>(n + 1, std::vector<double>(n + 1)));
+    for (size_t i = 0; i <= n; ++i)
+        for (size_t j = 0; j <= n; ++j)
+            grown[i][j] = i < n && j < n ? M[i][j] : (i == n && j == n ? 4.0 : (i == n ? row[j] : col[i]));
+    assert(max_abs_diff(lu_product(lu), grown) < 1e-12);
+
+    Matrix<double> current = grown;
+    for (size_t k : {6, 0, 3, 1}) {
+        lu.remove(k);
+        Matrix<double> smaller(std::vector<std::vector<double>>(current.getRows() - 1,
+                                                                std::vector<double>(current.getRows() - 1)));
+        for (size_t i = 0; i + 1 < current.getRows(); ++i)
+            for (size_t j = 0; j + 1 < current.getRows(); ++j)
+                smaller[i][j] = current[i < k ? i : i + 1][j < k ? j : j + 1];
+        current = smaller;
+        assert(lu.size() == current.getRows());
+        assert(max_abs_diff(lu_product(lu), current) < 1e-10);
+        assert(Permutation(lu.permutation()).sign() == lu.sign());
+    }
+
+    // QR: rows and columns in and out
+    QR<double> qr(B);
+    check_qr(qr, B);
+    Vector<double> extra({1, 0.5, -2, 1, 0, 3});
+    qr.append_row(extra);
+    std::vector<std::vector<double>> rows(n + 3, std::vector<double>(n));
+    for (size_t i = 0; i < n + 2; ++i)
+        rows[i] = B[i];
+    for (size_t j = 0; j < n; ++j)
+        rows[n + 2][j] = extra[j];
+    check_qr(qr, Matrix<double>(rows));
+    qr.remove_row(2);
+    rows.erase(rows.begin() + 2);
+    check_qr(qr, Matrix<double>(rows));
+    qr.remove_col(1);
+    for (std::vector<double>& r : rows)
+        r.erase(r.begin() + 1);
+    check_qr(qr, Matrix<double>(rows));
+    Vector<double> new_col{std::vector<double>(rows.size())};
+    for (size_t i = 0; i < rows.size(); ++i) {
+        new_col[i] = std::cos(double(i));
+        rows[i].push_back(new_col[i]);
+    }
+    qr.append_col(new_col);
+    Matrix<double> final_A(rows);
+    check_qr(qr, final_A);
+
+    // Least squares: the residual is orthogonal to the columns
+    Vector<double> rhs{std::vector<double>(rows.size())};
+    for (size_t i = 0; i < rows.size(); ++i)
+        rhs[i] = double(i % 3) - 1;
+    Vector<double> ls = qr.solve(rhs);
+    Vector<double> residual = mul_vec(final_A, ls);
+    for (size_t i = 0; i < rows.size(); ++i)
+        residual[i] = rhs[i] - residual[i];
+    Vector<double> normal = mul_vec(transpose(final_A), residual);
+    for (size_t j = 0; j < normal.getSize(); ++j)
+        assert(std::fabs(normal[j]) < 1e-10);
+
+    // Rank deficiency is relative to the scale of A: 1e-11·A has solution 1e11·x
+    std::vector<std::vector<double>> tiny(rows);
+    for (std::vector<double>& r : tiny)
+        for (double& a : r)
+            a *= 1e-11;
+    Vector<double> tiny_ls = QR<double>(Matrix<double>(tiny)).solve(rhs);
+    for (size_t j = 0; j < ls.getSize(); ++j)
+        assert(std::fabs(tiny_ls[j] * 1e-11 - ls[j]) < 1e-8 * (1 + std::fabs(ls[j])));
+    thrown = false;
+    try {
+        QR<double>(transpose(final_A)).solve(Vector<double>{std::vector<double>(final_A.getCols())});
+    } catch (const std::invalid_argument& e) {
+        thrown = std::string(e.what()) == "Least squares needs at least as many rows as columns";
+    }
+    assert(thrown);
+    std::cout << "Factorisation update tests passed!" << std::endl;
+}
+
+void test_transform_inverse() {
+    std::cout << "Testing closed-form 4x4 inverses..." << std::endl;
+
+    // General 4x4: closed form against Gauss-Jordan on the 5x5 [A 0; 0 1]
+    Matrix<double> A({{2, -1, 0, 3}, {1, 4, -2, 0}, {0, 1, 5, 1}, {-3, 0, 2, 1}});
+    Matrix<double> padded(std::vector<std::vector<double>>(5, std::vector<double>(5)));
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            padded[i][j] = A[i][j];
+    padded[4][4] = 1;
+    Matrix<double> reference = inverse(padded);
+    Matrix<double> inv = inverse(A);
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(std::fabs(inv[i][j] - reference[i][j]) < 1e-12);
+    Matrix<double> in_place(A);
+    in_place.inverse();
+    assert(max_abs_diff(in_place, inv) == 0);
+
+    // The float kernel agrees with the double one
+    Matrix<f32> Af({{2, -1, 0, 3}, {1, 4, -2, 0}, {0, 1, 5, 1}, {-3, 0, 2, 1}});
+    Matrix<f32> invf = inverse(Af);
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(std::fabs(double(invf[i][j]) - inv[i][j]) < 1e-6);
+
+    // Singularity is relative to the scale of the entries
+    Matrix<double> tiny({{1e-3, 0, 0, 0}, {0, 1e-3, 0, 0}, {0, 0, 1e-3, 0}, {0, 0, 0, 2e-3}});
+    assert(std::fabs(inverse(tiny)[3][3] - 500) < 1e-9);
+    bool thrown = false;
+    try {
+        inverse(Matrix<f32>({{1, 2, 3, 4}, {5, 6, 7, 8}, {1, 2, 3, 4}, {9, 10, 11, 12}}));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Rigid and affine transforms: rotation about z, then a scale
+    double c = std::cos(0.7), sn = std::sin(0.7);
+    Matrix<double> rigid({{c, -sn, 0, 1.5}, {sn, c, 0, -2}, {0, 0, 1, 3}, {0, 0, 0, 1}});
+    Matrix<double> rigid_inv = rigid_inverse(rigid);
+    assert(max_abs_diff(mul_mat(rigid, rigid_inv), identity_matrix<double>(4)) < 1e-14);
+    assert(max_abs_diff(rigid_inv, affine_inverse(rigid)) < 1e-14);
+    assert(max_abs_diff(rigid_inv, inverse(rigid)) < 1e-14);
+    Matrix<double> affine(rigid);
+    for (size_t j = 0; j < 3; ++j)
+        affine[j][0] *= 4;
+    affine[1][2] = 0.5;
+    Matrix<double> affine_inv = affine_inverse(affine);
+    assert(max_abs_diff(mul_mat(affine_inv, affine), identity_matrix<double>(4)) < 1e-14);
+    assert(max_abs_diff(affine_inv, inverse(affine)) == 0);
+
+    thrown = false;
+    try {
+        rigid_inverse(A);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Closed-form 4x4 inverse tests passed!" << std::endl;
+}
+
 int main() {
     test_basic_inverse();
     test_2x2_inverse();
@@ -188,6 +909,15 @@ int main() {
     test_symmetric_matrix_inverse();
     test_inverse_properties();
     test_methods();
+    test_krylov_solvers();
+    test_mixed_precision();
+    test_triangular_kernels();
+    test_pow_expm();
+    test_banded();
+    test_structured();
+    test_inverse_updates();
+    test_factor_updates();
+    test_transform_inverse();
     
     std::cout << "✅ All unit tests passed!" << std::endl;
 
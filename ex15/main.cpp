@@ -0,0 +1,202 @@
+#include "../includes/vector.hpp"
+#include "../includes/matrix.hpp"
+#include "../includes/utils.hpp"
+#include "../includes/blas.hpp"
+#include <cassert>
+#include <complex>
+#include <iostream>
+
+using c32 = std::complex<f32>;
+
+// Helper function to compare complex numbers with tolerance
+bool complex_equal(c32 a, c32 b, f32 epsilon = 1e-4f) {
+    return std::abs(a - b) < epsilon;
+}
+
+bool vectors_equal(const Vector<c32>& v, const Vector<c32>& u, f32 epsilon = 1e-4f) {
+    if (v.getSize() != u.getSize())
+        return false;
+    for (size_t i = 0; i < v.getSize(); i++)
+        if (!complex_equal(v[i], u[i], epsilon))
+            return false;
+    return true;
+}
+
+bool matrices_equal(const Matrix<c32>& m1, const Matrix<c32>& m2, f32 epsilon = 1e-4f) {
+    if (m1.getRows() != m2.getRows() || m1.getCols() != m2.getCols())
+        return false;
+    for (size_t i = 0; i < m1.getRows(); i++)
+        for (size_t j = 0; j < m1.getCols(); j++)
+            if (!complex_equal(m1[i][j], m2[i][j], epsilon))
+                return false;
+    return true;
+}
+
+void test_vector_space() {
+    std::cout << "Testing complex add/sub/scl/linear combination/lerp..." << std::endl;
+
+    Vector<c32> v({{1, 2}, {3, -1}});
+    Vector<c32> u({{0, 1}, {2, 2}});
+
+    assert(vectors_equal(v + u, Vector<c32>({{1, 3}, {5, 1}})));
+    assert(vectors_equal(v - u, Vector<c32>({{1, 1}, {1, -3}})));
+    // (1 + 2i)·i = -2 + i
+    assert(vectors_equal(scl(v, c32(0, 1)), Vector<c32>({{-2, 1}, {1, 3}})));
+    assert(vectors_equal(linear_combination(std::vector<Vector<c32>>{v, u}, {c32(2, 0), c32(0, 1)}),
+                         Vector<c32>({{1, 4}, {4, 0}})));
+    assert(vectors_equal(lerp(v, u, c32(0.5f, 0)), Vector<c32>({{0.5f, 1.5f}, {2.5f, 0.5f}})));
+
+    std::cout << "Complex vector space tests passed!" << std::endl;
+}
+
+void test_dot_and_norms() {
+    std::cout << "Testing complex dot product and norms..." << std::endl;
+
+    Vector<c32> v({{1, 1}, {0, 2}});
+    Vector<c32> u({{2, 0}, {1, 1}});
+
+    // conj(1 + i)·2 + conj(2i)·(1 + i) = (2 - 2i) + (2 - 2i)
+    assert(complex_equal(dot(v, u), c32(4, -4)));
+    assert(complex_equal(v.dot(u), c32(4, -4)));
+    // The Hermitian product of a vector with itself is real
+    assert(complex_equal(dot(v, v), c32(6, 0)));
+
+    assert(std::abs(norm(v) - std::sqrt(6.0f)) < 1e-5f);
+    assert(std::abs(norm_1(v) - (std::sqrt(2.0f) + 2.0f)) < 1e-5f);
+    assert(std::abs(norm_inf(v) - 2.0f) < 1e-5f);
+
+    assert(std::abs(angle_cos(v, v) - c32(1, 0)) < 1e-5f);
+    assert(std::abs(angle_cos(v, u)) <= 1.0f + 1e-5f);
+
+    Vector<c32> n = normalize(v);
+    assert(std::abs(norm(n) - 1.0f) < 1e-5f);
+
+    std::cout << "Complex dot product and norm tests passed!" << std::endl;
+}
+
+void test_cross_product() {
+    std::cout << "Testing complex cross product..." << std::endl;
+
+    Vector<c32> v({{1, 0}, {0, 0}, {0, 0}});
+    Vector<c32> u({{0, 0}, {0, 1}, {0, 0}});
+    assert(vectors_equal(cross_product(v, u), Vector<c32>({{0, 0}, {0, 0}, {0, 1}})));
+
+    std::cout << "Complex cross product tests passed!" << std::endl;
+}
+
+void test_mul_mat() {
+    std::cout << "Testing complex matrix multiplication..." << std::endl;
+
+    // Odd sizes so the SIMD kernel goes through its vector and scalar tails
+    size_t m = 5, n = 7, p = 9;
+    std::vector<std::vector<c32>> a(m, std::vector<c32>(n)), b(n, std::vector<c32>(p));
+    for (size_t i = 0; i < m; i++)
+        for (size_t k = 0; k < n; k++)
+            a[i][k] = c32(f32(i + k) * 0.5f, f32(i) - f32(k));
+    for (size_t k = 0; k < n; k++)
+        for (size_t j = 0; j < p; j++)
+            b[k][j] = c32(f32(j) - 1.0f, f32(k * j % 5) * 0.25f);
+    Matrix<c32> A(a), B(b);
+
+    Matrix<c32> expected(std::vector<std::vector<c32>>(m, std::vector<c32>(p)));
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < p; j++)
+            for (size_t k = 0; k < n; k++)
+                expected[i][j] += a[i][k] * b[k][j];
+
+    assert(matrices_equal(mul_mat(A, B), expected));
+    Matrix<c32> member(A);
+    member.mul_mat(B);
+    assert(matrices_equal(member, expected));
+
+    Vector<c32> x({{1, 0}, {0, 1}});
+    Matrix<c32> M({{{1, 1}, {2, 0}}, {{0, 0}, {1, -1}}});
+    assert(vectors_equal(mul_vec(M, x), Vector<c32>({{1, 3}, {1, 1}})));
+
+    std::cout << "Complex matrix multiplication tests passed!" << std::endl;
+}
+
+void test_transpose_trace() {
+    std::cout << "Testing complex trace and (conjugate) transpose..." << std::endl;
+
+    Matrix<c32> M({{{1, 1}, {2, -3}}, {{0, 4}, {5, 0}}});
+    assert(complex_equal(M.trace(), c32(6, 1)));
+    assert(matrices_equal(transpose(M), Matrix<c32>({{{1, 1}, {0, 4}}, {{2, -3}, {5, 0}}})));
+
+    Matrix<c32> H = conj_transpose(M);
+    assert(matrices_equal(H, Matrix<c32>({{{1, -1}, {0, -4}}, {{2, 3}, {5, 0}}})));
+    M.conj_transpose();
+    assert(matrices_equal(M, H));
+
+    std::cout << "Complex trace and transpose tests passed!" << std::endl;
+}
+
+void test_elimination() {
+    std::cout << "Testing complex row echelon, determinant, inverse and rank..." << std::endl;
+
+    Matrix<c32> M({{{2, 0}, {0, 1}}, {{0, -1}, {3, 0}}});
+    // 2·3 - (i)(-i) = 6 - 1
+    assert(complex_equal(M.determinant(), c32(5, 0)));
+
+    Matrix<c32> I({{{1, 0}, {0, 0}}, {{0, 0}, {1, 0}}});
+    assert(matrices_equal(row_echelon(M), I));
+
+    Matrix<c32> product = mul_mat(M, inverse(M));
+    assert(matrices_equal(product, I));
+
+    Matrix<c32> singular({{{1, 1}, {2, 2}}, {{2, 2}, {4, 4}}});
+    assert(complex_equal(singular.rank(), c32(1, 0)));
+
+    Matrix<c32> four({
+        {{1, 0}, {0, 1}, {0, 0}, {0, 0}},
+        {{0, 0}, {1, 0}, {0, 0}, {0, 0}},
+        {{0, 0}, {0, 0}, {2, 0}, {0, 0}},
+        {{0, 0}, {0, 0}, {0, 0}, {0, 1}}
+    });
+    assert(complex_equal(four.determinant(), c32(0, 2)));
+
+    std::cout << "Complex elimination tests passed!" << std::endl;
+}
+
+void test_gemm_conj() {
+    std::cout << "Testing gemm and gemv with conjugate transposes..." << std::endl;
+
+    Matrix<c32> A({{{1, 2}, {0, -1}, {3, 0}}, {{2, -1}, {1, 1}, {0, 2}}});
+    Matrix<c32> B({{{1, 0}, {2, 1}}, {{0, 1}, {1, -1}}});
+    // Aᴴ·Bᴴ = (B·A)ᴴ
+    Matrix<c32> expected = conj_transpose(mul_mat(B, A));
+    Matrix<c32> C(std::vector<std::vector<c32>>(3, std::vector<c32>(2, c32(1, 1))));
+    gemm(c32(1), A, B, c32(0), C, Op::ConjTrans, Op::ConjTrans);
+    assert(matrices_equal(C, expected));
+
+    // A·Aᴴ accumulated onto the identity
+    Matrix<c32> G({{{1, 0}, {0, 0}}, {{0, 0}, {1, 0}}});
+    gemm(c32(1), A, A, c32(1), G, Op::NoTrans, Op::ConjTrans);
+    Matrix<c32> AAh = mul_mat(A, conj_transpose(A));
+    assert(complex_equal(G[0][0], AAh[0][0] + c32(1)) && complex_equal(G[0][1], AAh[0][1]));
+    assert(complex_equal(G[0][0].imag(), 0) && complex_equal(G[1][0], std::conj(G[0][1])));
+
+    Vector<c32> x({{1, 1}, {0, 2}});
+    Vector<c32> y;
+    gemv(c32(1), A, x, c32(0), y, Op::ConjTrans);
+    assert(vectors_equal(y, mul_vec(conj_transpose(A), x)));
+
+    // AᴴA is Hermitian with a real diagonal
+    Matrix<c32> H = gram(A);
+    assert(matrices_equal(H, mul_mat(conj_transpose(A), A)));
+    assert(matrices_equal(H, conj_transpose(H)));
+    std::cout << "Complex gemm/gemv tests passed!" << std::endl;
+}
+
+int main() {
+    test_vector_space();
+    test_dot_and_norms();
+    test_cross_product();
+    test_mul_mat();
+    test_transpose_trace();
+    test_elimination();
+    test_gemm_conj();
+
+    std::cout << "✅ All unit tests passed!" << std::endl;
+    return 0;
+}
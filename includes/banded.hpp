@@ -0,0 +1,426 @@
+#pragma once
+
+#include "complex.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/*
+* Banded and tridiagonal systems.
+*
+* A BandMatrix keeps only the diagonals from -lower to +upper, each one stored
+* contiguously and indexed by row (diagonal-major). A mat-vec then walks every
+* diagonal as a single stride-1 loop y[i] += d[i]·x[i + offset], which the
+* compiler vectorises, instead of short rows of varying length.
+*
+* BandLU factorises with partial pivoting in O(n·lower·(lower + upper)):
+* row exchanges widen U to lower + upper superdiagonals, so each working row
+* has room for that fill. As in LAPACK's gbtrf, the multipliers are kept per
+* elimination step and the exchanges are replayed in order when solving.
+*
+* Tridiagonal systems (lower = upper = 1) can also go through the Thomas
+* algorithm, O(n) without pivoting: stable for diagonally dominant or
+* symmetric positive definite matrices, which is what PDE stencils produce.
+* TridiagonalBatch interleaves many independent systems of the same size so
+* that the sweep runs across systems with unit stride.
+*
+* As in LU, a pivot of at most 1e-10 times the largest stored entry (of each
+* system for TridiagonalBatch) is reported as singular, so the outcome does
+* not depend on the scale of the matrix.
+*/
+
+const size_t TRIDIAGONAL_GRAIN = 64;
+
+template <typename K>
+class BandMatrix {
+
+    private:
+        size_t _n;
+        size_t _lower;
+        size_t _upper;
+        std::vector<K> _bands;  // diagonal j - i = d stored at [(d + _lower)·_n + i]
+
+    public:
+        /**
+         * @brief n x n zero matrix with `lower` sub- and `upper` superdiagonals
+         */
+        BandMatrix(size_t n, size_t lower, size_t upper)
+            : _n(n), _lower(lower), _upper(upper), _bands((lower + upper + 1) * n) {}
+
+        /**
+         * @brief Keeps the band of a dense square matrix, entries outside are dropped
+         * @throws std::invalid_argument If A is not square
+         */
+        static BandMatrix from_dense(const Matrix<K>& A, size_t lower, size_t upper)
+        {
+            if (A.getRows() && A.getCols() != A.getRows())
+                throw std::invalid_argument("Matrix must be square");
+            BandMatrix B(A.getRows(), lower, upper);
+            for (size_t i = 0; i < B._n; ++i) {
+                size_t lo = i > lower ? i - lower : 0;
+                size_t hi = std::min(B._n, i + upper + 1);
+                for (size_t j = lo; j < hi; ++j)
+                    B._bands[(j + lower - i) * B._n + i] = A[i][j];
+            }
+            return B;
+        }
+
+        size_t size() const { return _n; }
+        size_t lower() const { return _lower; }
+        size_t upper() const { return _upper; }
+
+        bool in_band(size_t i, size_t j) const
+        {
+            return i < _n && j < _n && j + _lower >= i && i + _upper >= j;
+        }
+
+        /**
+         * @brief Element (i, j), zero outside of the band
+         */
+        K operator()(size_t i, size_t j) const
+        {
+            return in_band(i, j) ? _bands[(j + _lower - i) * _n + i] : K(0);
+        }
+
+        /**
+         * @brief Writable element (i, j)
+         * @throws std::out_of_range If (i, j) lies outside of the band
+         */
+        K& at(size_t i, size_t j)
+        {
+            if (!in_band(i, j))
+                throw std::out_of_range("Element outside of the band");
+            return _bands[(j + _lower - i) * _n + i];
+        }
+
+        /**
+         * @brief Diagonal `offset` (j - i), indexed by row: element i is (i, i + offset)
+         *
+         * Only rows max(0, -offset) to min(n, n - offset) are meaningful.
+         */
+        K* diagonal(long offset) { return _bands.data() + (offset + long(_lower)) * _n; }
+        const K* diagonal(long offset) const { return _bands.data() + (offset + long(_lower)) * _n; }
+
+        // Largest magnitude in the band, the padding of the short diagonals excluded
+        real_t<K> max_magnitude() const
+        {
+            real_t<K> scale = 0;
+            for (size_t d = 0; d <= _lower + _upper; ++d) {
+                size_t lo = d < _lower ? _lower - d : 0;
+                size_t hi = d > _lower ? _n - std::min(_n, d - _lower) : _n;
+                for (size_t i = lo; i < hi; ++i)
+                    scale = std::max(scale, magnitude(_bands[d * _n + i]));
+            }
+            return scale;
+        }
+
+        Matrix<K> to_dense() const
+        {
+            Matrix<K> A(std::vector<std::vector<K>>(_n, std::vector<K>(_n)));
+            for (size_t i = 0; i < _n; ++i) {
+                size_t lo = i > _lower ? i - _lower : 0;
+                size_t hi = std::min(_n, i + _upper + 1);
+                for (size_t j = lo; j < hi; ++j)
+                    A[i][j] = (*this)(i, j);
+            }
+            return A;
+        }
+};
+
+/**
+ * @brief out = B·u, one stride-1 pass per stored diagonal
+ *
+ * Like mul_vec(Matrix, u, out) it does not allocate once `out` is sized, so a
+ * BandMatrix can be handed to the Krylov solvers.
+ *
+ * @throws std::invalid_argument If u does not have n elements
+ */
+template <typename K>
+void mul_vec(const BandMatrix<K>& B, const Vector<K>& u, Vector<K>& out)
+{
+    size_t n = B.size();
+    if (u.getSize() != n)
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    if (out.getSize() != n)
+        out.resize(n);
+    const K* x = u.data();
+    K* y = out.data();
+    std::fill(y, y + n, K(0));
+    for (long d = -long(B.lower()); d <= long(B.upper()); ++d) {
+        size_t lo = d < 0 ? size_t(-d) : 0;
+        size_t hi = d > 0 ? n - std::min(n, size_t(d)) : n;
+        if (lo >= hi)
+            continue;
+        const K* band = B.diagonal(d) + lo;
+        const K* xs = x + (size_t(long(lo) + d));
+        K* ys = y + lo;
+        for (size_t i = 0; i < hi - lo; ++i)
+            ys[i] += band[i] * xs[i];
+    }
+}
+
+template <typename K>
+Vector<K> mul_vec(const BandMatrix<K>& B, const Vector<K>& u)
+{
+    Vector<K> out;
+    mul_vec(B, u, out);
+    return out;
+}
+
+/**
+ * @brief Banded LU factorisation with partial pivoting
+ *
+ * Storage is n·(2·lower + upper + 1) for U and n·lower for the multipliers,
+ * so factorising and solving stay linear in n for a fixed bandwidth.
+ */
+template <typename K>
+class BandLU {
+
+    private:
+        size_t _n;
+        size_t _lower;
+        size_t _width;                // superdiagonals of U: lower + upper
+        std::vector<K> _u;            // row i holds columns [i, i + _width] at [i·(_width + 1) + j - i]
+        std::vector<K> _l;            // step k multipliers for rows k + 1 .. k + _lower
+        std::vector<size_t> _pivots;  // step k exchanged rows k and _pivots[k]
+
+    public:
+        /**
+         * @brief Factorises B
+         * @throws std::runtime_error If B is singular
+         * @time_complexity O(n·lower·(lower + upper))
+         */
+        explicit BandLU(const BandMatrix<K>& B)
+            : _n(B.size()), _lower(B.lower()), _width(B.lower() + B.upper()),
+              _u(_n * (_width + 1)), _l(_n * _lower), _pivots(_n)
+        {
+            size_t ld = _width + 1;
+            // Working rows cover columns [i - lower, i + width]; the columns
+            // left of the diagonal are only read while they get eliminated
+            size_t wide = _lower + ld;
+            std::vector<K> work(_n * wide);
+            for (size_t i = 0; i < _n; ++i)
+                for (size_t j = (i > _lower ? i - _lower : 0); j < std::min(_n, i + B.upper() + 1); ++j)
+                    work[i * wide + j + _lower - i] = B(i, j);
+            real_t<K> tol = real_t<K>(1e-10) * B.max_magnitude();
+            auto elem = [&work, wide, this](size_t i, size_t j) -> K& {
+                return work[i * wide + j + _lower - i];
+            };
+
+            for (size_t k = 0; k < _n; ++k) {
+                size_t last = std::min(_n - 1, k + _lower);
+                size_t p = k;
+                for (size_t i = k + 1; i <= last; ++i)
+                    if (magnitude(elem(i, k)) > magnitude(elem(p, k)))
+                        p = i;
+                if (!(magnitude(elem(p, k)) > tol))
+                    throw std::runtime_error("Matrix is singular and cannot be inverted");
+                _pivots[k] = p;
+                size_t end = std::min(_n, k + _width + 1);
+                if (p != k)
+                    for (size_t j = k; j < end; ++j)
+                        std::swap(elem(k, j), elem(p, j));
+
+                K pivot = elem(k, k);
+                for (size_t i = k + 1; i <= last; ++i) {
+                    K l = elem(i, k) / pivot;
+                    _l[k * _lower + (i - k - 1)] = l;
+                    if (l == K(0))
+                        continue;
+                    for (size_t j = k + 1; j < end; ++j)
+                        elem(i, j) -= l * elem(k, j);
+                }
+                for (size_t j = k; j < end; ++j)
+                    _u[k * ld + j - k] = elem(k, j);
+            }
+        }
+
+        size_t size() const { return _n; }
+
+        /**
+         * @brief Solves B·x = b into an existing vector (no allocation once x is sized)
+         * @throws std::invalid_argument If b does not have n elements
+         */
+        void solve(const Vector<K>& b, Vector<K>& x) const
+        {
+            if (b.getSize() != _n)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            if (&x != &b)
+                x = b;
+            K* px = x.data();
+            size_t ld = _width + 1;
+            for (size_t k = 0; k < _n; ++k) {
+                std::swap(px[k], px[_pivots[k]]);
+                size_t last = std::min(_n - 1, k + _lower);
+                for (size_t i = k + 1; i <= last; ++i)
+                    px[i] -= _l[k * _lower + (i - k - 1)] * px[k];
+            }
+            for (size_t k = _n; k-- > 0;) {
+                const K* row = _u.data() + k * ld;
+                size_t end = std::min(_n, k + ld);
+                K sum = px[k];
+                for (size_t j = k + 1; j < end; ++j)
+                    sum -= row[j - k] * px[j];
+                px[k] = sum / row[0];
+            }
+        }
+
+        Vector<K> solve(const Vector<K>& b) const
+        {
+            Vector<K> x;
+            solve(b, x);
+            return x;
+        }
+};
+
+/**
+ * @brief Solves a tridiagonal system with the Thomas algorithm in O(n)
+ *
+ * No pivoting: meant for diagonally dominant or symmetric positive definite
+ * matrices, use BandLU otherwise.
+ *
+ * @param T A BandMatrix with one sub- and one superdiagonal
+ * @param x The solution, resized if needed (may alias b)
+ * @throws std::invalid_argument If T is not tridiagonal or b does not have n elements
+ * @throws std::runtime_error If a pivot vanishes
+ */
+template <typename K>
+void thomas_solve(const BandMatrix<K>& T, const Vector<K>& b, Vector<K>& x)
+{
+    if (T.lower() != 1 || T.upper() != 1)
+        throw std::invalid_argument("The matrix must be tridiagonal");
+    size_t n = T.size();
+    if (b.getSize() != n)
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    if (&x != &b)
+        x = b;
+    if (n == 0)
+        return;
+    const K* sub = T.diagonal(-1);
+    const K* diag = T.diagonal(0);
+    const K* super = T.diagonal(1);
+    K* px = x.data();
+    std::vector<K> c(n);
+    real_t<K> tol = real_t<K>(1e-10) * T.max_magnitude();
+    K pivot = diag[0];
+    for (size_t i = 0;; ++i) {
+        if (!(magnitude(pivot) > tol))
+            throw std::runtime_error("Matrix is singular and cannot be inverted");
+        px[i] /= pivot;
+        if (i + 1 == n)
+            break;
+        c[i] = super[i] / pivot;
+        pivot = diag[i + 1] - sub[i + 1] * c[i];
+        px[i + 1] -= sub[i + 1] * px[i];
+    }
+    for (size_t i = n - 1; i-- > 0;)
+        px[i] -= c[i] * px[i + 1];
+}
+
+template <typename K>
+Vector<K> thomas_solve(const BandMatrix<K>& T, const Vector<K>& b)
+{
+    Vector<K> x;
+    thomas_solve(T, b, x);
+    return x;
+}
+
+/**
+ * @brief `count` independent tridiagonal systems of size n
+ *
+ * Element i of system s is stored at [i·count + s] in each of the three
+ * diagonals, so one step of the Thomas sweep touches consecutive memory for
+ * all the systems. sub(s, 0) and super(s, n - 1) are unused.
+ */
+template <typename K>
+class TridiagonalBatch {
+
+    private:
+        size_t _count;
+        size_t _n;
+        std::vector<K> _sub;
+        std::vector<K> _diag;
+        std::vector<K> _super;
+
+    public:
+        TridiagonalBatch(size_t count, size_t n)
+            : _count(count), _n(n), _sub(count * n), _diag(count * n), _super(count * n) {}
+
+        size_t count() const { return _count; }
+        size_t size() const { return _n; }
+
+        K& sub(size_t s, size_t i) { return _sub[i * _count + s]; }
+        K& diag(size_t s, size_t i) { return _diag[i * _count + s]; }
+        K& super(size_t s, size_t i) { return _super[i * _count + s]; }
+        const K& sub(size_t s, size_t i) const { return _sub[i * _count + s]; }
+        const K& diag(size_t s, size_t i) const { return _diag[i * _count + s]; }
+        const K& super(size_t s, size_t i) const { return _super[i * _count + s]; }
+
+        /**
+         * @brief Solves every system in place, systems split over threads
+         *
+         * @param rhs count·n right hand sides in the same interleaved layout,
+         *            overwritten with the solutions
+         * @param threads Maximum number of threads, 0 for hardware_threads()
+         * @throws std::invalid_argument If rhs does not hold count·n elements
+         * @throws std::runtime_error If a pivot vanishes in any system
+         */
+        void solve(std::vector<K>& rhs, size_t threads = 0) const
+        {
+            if (rhs.size() != _count * _n)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            if (_n == 0)
+                return;
+            K* x = rhs.data();
+            parallel_for(0, _count, TRIDIAGONAL_GRAIN, [this, x](size_t lo, size_t hi) {
+                size_t m = hi - lo;
+                std::vector<K> c(_n * m);
+                std::vector<K> pivot(m);
+                std::vector<real_t<K>> tol(m);
+                const K* a = _sub.data();
+                const K* d = _diag.data();
+                const K* u = _super.data();
+                for (size_t i = 0; i < _n; ++i) {
+                    size_t row = i * _count + lo;
+                    for (size_t s = 0; s < m; ++s) {
+                        real_t<K> e = magnitude(d[row + s]);
+                        if (i > 0)
+                            e = std::max(e, magnitude(a[row + s]));
+                        if (i + 1 < _n)
+                            e = std::max(e, magnitude(u[row + s]));
+                        tol[s] = std::max(tol[s], e);
+                    }
+                }
+                for (size_t s = 0; s < m; ++s) {
+                    tol[s] *= real_t<K>(1e-10);
+                    pivot[s] = d[lo + s];
+                }
+                for (size_t i = 0;; ++i) {
+                    size_t row = i * _count + lo;
+                    for (size_t s = 0; s < m; ++s)
+                        if (!(magnitude(pivot[s]) > tol[s]))
+                            throw std::runtime_error("Matrix is singular and cannot be inverted");
+                    for (size_t s = 0; s < m; ++s)
+                        x[row + s] /= pivot[s];
+                    if (i + 1 == _n)
+                        break;
+                    size_t next = row + _count;
+                    K* ci = c.data() + i * m;
+                    for (size_t s = 0; s < m; ++s) {
+                        ci[s] = u[row + s] / pivot[s];
+                        pivot[s] = d[next + s] - a[next + s] * ci[s];
+                        x[next + s] -= a[next + s] * x[row + s];
+                    }
+                }
+                for (size_t i = _n - 1; i-- > 0;) {
+                    size_t row = i * _count + lo;
+                    const K* ci = c.data() + i * m;
+                    for (size_t s = 0; s < m; ++s)
+                        x[row + s] -= ci[s] * x[row + _count + s];
+                }
+            }, threads);
+        }
+};
@@ -0,0 +1,766 @@
+#pragma once
+
+#include "complex.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "reduction.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/*
+* Dense BLAS-style kernels.
+*
+* Matrix stores one std::vector per row, so the kernels take accessors:
+* callables returning a pointer to row i, either M[i].data() for a Matrix or
+* base + i·ld for a contiguous buffer (the left operand of the product is read
+* element by element, a(i, k), which also covers its transpose). The product kernel is blocked for the
+* cache: KC columns of A (and rows of B) and NC columns of B stay resident
+* while the rows of C stream through, the inner loop being a contiguous row
+* AXPY (SIMD for f32 and f64).
+*/
+
+const size_t GEMM_KC = 256;
+const size_t GEMM_NC = 1024;
+const size_t GEMM_GRAIN = 16;
+const size_t STRASSEN_CROSSOVER = 128;
+
+/**
+ * @brief y[j] += a·x[j] for j in [0, n)
+ */
+template <typename K>
+void row_axpy(K* y, K a, const K* x, size_t n)
+{
+    size_t j = 0;
+    if constexpr (std::is_same_v<K, float>) {
+#if defined(__AVX__)
+        const __m256 va = _mm256_set1_ps(a);
+        for (; j + 8 <= n; j += 8) {
+# if defined(__FMA__)
+            __m256 r = _mm256_fmadd_ps(va, _mm256_loadu_ps(x + j), _mm256_loadu_ps(y + j));
+# else
+            __m256 r = _mm256_add_ps(_mm256_mul_ps(va, _mm256_loadu_ps(x + j)), _mm256_loadu_ps(y + j));
+# endif
+            _mm256_storeu_ps(y + j, r);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128 wa = _mm_set1_ps(a);
+        for (; j + 4 <= n; j += 4)
+            _mm_storeu_ps(y + j, _mm_add_ps(_mm_mul_ps(wa, _mm_loadu_ps(x + j)), _mm_loadu_ps(y + j)));
+#endif
+    } else if constexpr (std::is_same_v<K, double>) {
+#if defined(__AVX__)
+        const __m256d va = _mm256_set1_pd(a);
+        for (; j + 4 <= n; j += 4) {
+# if defined(__FMA__)
+            __m256d r = _mm256_fmadd_pd(va, _mm256_loadu_pd(x + j), _mm256_loadu_pd(y + j));
+# else
+            __m256d r = _mm256_add_pd(_mm256_mul_pd(va, _mm256_loadu_pd(x + j)), _mm256_loadu_pd(y + j));
+# endif
+            _mm256_storeu_pd(y + j, r);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128d wa = _mm_set1_pd(a);
+        for (; j + 2 <= n; j += 2)
+            _mm_storeu_pd(y + j, _mm_add_pd(_mm_mul_pd(wa, _mm_loadu_pd(x + j)), _mm_loadu_pd(y + j)));
+#endif
+    } else if constexpr (ScalarTraits<K>::is_complex) {
+        complex_axpy(y, a, x, n);
+        return;
+    }
+    for (; j < n; ++j)
+        y[j] += a * x[j];
+}
+
+/**
+ * @brief C += alpha·A·B on rows [row_lo, row_hi) of C, cache blocked
+ *
+ * @param n Inner dimension (columns of A, rows of B)
+ * @param p Columns of B and C
+ * @param a Element accessor, a(i, k) is A[i][k]
+ * @param b, c Row accessors: b(k) is a pointer to row k of B
+ */
+template <typename K, typename ElemA, typename RowB, typename RowC>
+void gemm_kernel(size_t row_lo, size_t row_hi, size_t n, size_t p, K alpha, ElemA a, RowB b, RowC c)
+{
+    for (size_t j0 = 0; j0 < p; j0 += GEMM_NC) {
+        size_t nj = std::min(GEMM_NC, p - j0);
+        for (size_t k0 = 0; k0 < n; k0 += GEMM_KC) {
+            size_t k1 = std::min(n, k0 + GEMM_KC);
+            for (size_t i = row_lo; i < row_hi; ++i) {
+                K* ci = c(i) + j0;
+                for (size_t k = k0; k < k1; ++k)
+                    row_axpy(ci, alpha * a(i, k), b(k) + j0, nj);
+            }
+        }
+    }
+}
+
+/*
+* Strassen-Winograd on contiguous square buffers (row-major, leading dimension ld).
+*
+* One level computes C = A·B with 7 half-size products instead of 8 and 15
+* additions, following the schedule of Douglas et al. (GEMMW) that only needs
+* two half-size temporaries X and Y per level, the quadrants of C holding the
+* other intermediate results. Each level takes its X and Y from the front of
+* the workspace and hands the rest to the level below, so a single buffer of
+* strassen_workspace() elements serves the whole recursion.
+*/
+
+// Elements of workspace needed below a padded size, 2·(s/2)² per level
+inline size_t strassen_workspace(size_t size, size_t levels)
+{
+    size_t total = 0;
+    for (size_t l = 0; l < levels; ++l) {
+        size /= 2;
+        total += 2 * size * size;
+    }
+    return total;
+}
+
+// Z = X - Y (subtract) or Z = X + Y on h x h blocks
+template <typename K>
+void strassen_add(size_t h, K* Z, size_t ldz, const K* X, size_t ldx, const K* Y, size_t ldy, bool subtract)
+{
+    for (size_t i = 0; i < h; ++i) {
+        K* z = Z + i * ldz;
+        const K* x = X + i * ldx;
+        const K* y = Y + i * ldy;
+        if (subtract)
+            for (size_t j = 0; j < h; ++j)
+                z[j] = x[j] - y[j];
+        else
+            for (size_t j = 0; j < h; ++j)
+                z[j] = x[j] + y[j];
+    }
+}
+
+// C = A·B for size x size blocks, size = n0·2^levels
+template <typename K>
+void strassen_winograd(size_t size, size_t levels, const K* A, size_t lda, const K* B, size_t ldb,
+                       K* C, size_t ldc, K* ws)
+{
+    if (levels == 0) {
+        for (size_t i = 0; i < size; ++i)
+            std::fill(C + i * ldc, C + i * ldc + size, K(0));
+        gemm_kernel(0, size, size, size, K(1),
+                    [A, lda](size_t i, size_t k) { return A[i * lda + k]; },
+                    [B, ldb](size_t i) { return B + i * ldb; },
+                    [C, ldc](size_t i) { return C + i * ldc; });
+        return;
+    }
+
+    size_t h = size / 2;
+    const K* A11 = A;
+    const K* A12 = A + h;
+    const K* A21 = A + h * lda;
+    const K* A22 = A21 + h;
+    const K* B11 = B;
+    const K* B12 = B + h;
+    const K* B21 = B + h * ldb;
+    const K* B22 = B21 + h;
+    K* C11 = C;
+    K* C12 = C + h;
+    K* C21 = C + h * ldc;
+    K* C22 = C21 + h;
+    K* X = ws;
+    K* Y = ws + h * h;
+    K* next = ws + 2 * h * h;
+    size_t l = levels - 1;
+
+    strassen_add(h, X, h, A11, lda, A21, lda, true);     // S3 = A11 - A21
+    strassen_add(h, Y, h, B22, ldb, B12, ldb, true);     // T3 = B22 - B12
+    strassen_winograd(h, l, X, h, Y, h, C21, ldc, next); // P7 = S3·T3
+    strassen_add(h, X, h, A21, lda, A22, lda, false);    // S1 = A21 + A22
+    strassen_add(h, Y, h, B12, ldb, B11, ldb, true);     // T1 = B12 - B11
+    strassen_winograd(h, l, X, h, Y, h, C22, ldc, next); // P5 = S1·T1
+    strassen_add(h, X, h, X, h, A11, lda, true);         // S2 = S1 - A11
+    strassen_add(h, Y, h, B22, ldb, Y, h, true);         // T2 = B22 - T1
+    strassen_winograd(h, l, X, h, Y, h, C12, ldc, next); // P6 = S2·T2
+    strassen_add(h, X, h, A12, lda, X, h, true);         // S4 = A12 - S2
+    strassen_winograd(h, l, X, h, B22, ldb, C11, ldc, next); // P3 = S4·B22
+    strassen_winograd(h, l, A11, lda, B11, ldb, X, h, next); // P1 = A11·B11
+    strassen_add(h, C12, ldc, X, h, C12, ldc, false);    // U2 = P1 + P6
+    strassen_add(h, C21, ldc, C12, ldc, C21, ldc, false); // U3 = U2 + P7
+    strassen_add(h, C12, ldc, C12, ldc, C22, ldc, false); // U4 = U2 + P5
+    strassen_add(h, C22, ldc, C21, ldc, C22, ldc, false); // C22 = U3 + P5
+    strassen_add(h, C12, ldc, C12, ldc, C11, ldc, false); // C12 = U4 + P3
+    strassen_add(h, Y, h, Y, h, B21, ldb, true);         // T4 = T2 - B21
+    strassen_winograd(h, l, A22, lda, Y, h, C11, ldc, next); // P4 = A22·T4
+    strassen_add(h, C21, ldc, C21, ldc, C11, ldc, true); // C21 = U3 - P4
+    strassen_winograd(h, l, A12, lda, B21, ldb, C11, ldc, next); // P2 = A12·B21
+    strassen_add(h, C11, ldc, X, h, C11, ldc, false);    // C11 = P1 + P2
+}
+
+enum class MulMode {
+    Classical,
+    Strassen
+};
+
+/**
+ * @brief How a product was computed and how accurate it is guaranteed to be
+ *
+ * error_bound bounds max |Ĉij - Cij| to first order. With n0 the size at
+ * which the recursion stops and u the unit roundoff it is
+ * ((n/n0)^log2(18)·(n0² + 6·n0) - 6·n)·u·max|Aij|·max|Bij| for ℓ > 0 levels
+ * (Higham's bound for the Winograd variant) and n²·u·max|Aij|·max|Bij| for the
+ * classical product. The bound grows with every level, which is what the
+ * crossover trades against speed.
+ */
+template <typename K>
+struct MulInfo {
+    size_t levels;
+    size_t padded_size;
+    real_t<K> error_bound;
+};
+
+/**
+ * @brief A·B with the classical blocked kernel or Strassen-Winograd
+ *
+ * Strassen applies to square products larger than `crossover`: the operands
+ * are copied into zero-padded contiguous buffers of size n0·2^ℓ (n0 the first
+ * halving of n that is <= crossover) and the recursion runs on one
+ * preallocated workspace, each leaf using the blocked kernel. Everything else,
+ * including rectangular products, uses the classical kernel, rows split over
+ * threads.
+ *
+ * @param mode Classical or Strassen
+ * @param crossover Size at or below which the recursion stops
+ * @param info If not null, receives the number of levels and the error bound
+ * @throws std::invalid_argument If the matrix sizes don't match or crossover is 0
+ */
+template <typename K>
+Matrix<K> mul_mat(const Matrix<K>& A, const Matrix<K>& B, MulMode mode,
+                  size_t crossover = STRASSEN_CROSSOVER, MulInfo<K>* info = nullptr)
+{
+    if (A.getCols() != B.getRows())
+        throw std::invalid_argument("The matrix sizes don't match.");
+    if (crossover == 0)
+        throw std::invalid_argument("The Strassen crossover must be positive.");
+    size_t m = A.getRows();
+    size_t n = A.getCols();
+    size_t p = B.getCols();
+    Matrix<K> C(std::vector<std::vector<K>>(m, std::vector<K>(p)));
+
+    size_t levels = 0;
+    size_t n0 = n;
+    if (mode == MulMode::Strassen && m == n && n == p) {
+        while (n0 > crossover) {
+            n0 = (n0 + 1) / 2;
+            ++levels;
+        }
+    }
+    size_t padded = n0 << levels;
+
+    if (levels == 0) {
+        parallel_for(0, m, GEMM_GRAIN, [&](size_t lo, size_t hi) {
+            gemm_kernel(lo, hi, n, p, K(1),
+                        [&A](size_t i, size_t k) { return A[i][k]; },
+                        [&B](size_t i) { return B[i].data(); },
+                        [&C](size_t i) { return C[i].data(); });
+        });
+    } else {
+        std::vector<K> buffers(3 * padded * padded + strassen_workspace(padded, levels), K(0));
+        K* Ap = buffers.data();
+        K* Bp = Ap + padded * padded;
+        K* Cp = Bp + padded * padded;
+        for (size_t i = 0; i < n; ++i) {
+            std::copy(A[i].begin(), A[i].end(), Ap + i * padded);
+            std::copy(B[i].begin(), B[i].end(), Bp + i * padded);
+        }
+        strassen_winograd(padded, levels, Ap, padded, Bp, padded, Cp, padded, Cp + padded * padded);
+        for (size_t i = 0; i < n; ++i)
+            std::copy(Cp + i * padded, Cp + i * padded + n, C[i].begin());
+    }
+
+    if (info) {
+        real_t<K> max_a = 0;
+        real_t<K> max_b = 0;
+        for (size_t i = 0; i < m; ++i)
+            for (size_t k = 0; k < n; ++k)
+                max_a = std::max(max_a, magnitude(A[i][k]));
+        for (size_t k = 0; k < n; ++k)
+            for (size_t j = 0; j < p; ++j)
+                max_b = std::max(max_b, magnitude(B[k][j]));
+        real_t<K> u = std::numeric_limits<real_t<K>>::epsilon() / 2;
+        real_t<K> factor = real_t<K>(n) * real_t<K>(n);
+        if (levels > 0) {
+            real_t<K> base = real_t<K>(n0);
+            factor = std::pow(real_t<K>(padded) / base, std::log2(real_t<K>(18))) * (base * base + 6 * base)
+                     - 6 * real_t<K>(padded);
+        }
+        info->levels = levels;
+        info->padded_size = levels ? padded : n;
+        info->error_bound = factor * u * max_a * max_b;
+    }
+    return C;
+}
+
+/*
+* In-place products with alpha/beta scaling, as in BLAS xGEMM and xGEMV.
+*
+* The result is accumulated into an existing C (or y) instead of a new
+* Matrix, so iterative code can do C ← alpha·op(A)·op(B) + beta·C in one
+* pass without allocating. op() is selected per operand.
+*/
+
+enum class Op {
+    NoTrans,
+    Trans,
+    ConjTrans
+};
+
+// Element (i, k) of op(M)
+template <typename K>
+K op_elem(const Matrix<K>& M, Op op, size_t i, size_t k)
+{
+    if (op == Op::NoTrans)
+        return M[i][k];
+    return op == Op::ConjTrans ? conjugate(M[k][i]) : M[k][i];
+}
+
+// C ← beta·C, with beta = 0 clearing C even if it holds NaN or inf (BLAS convention)
+template <typename K>
+void scale_rows(Matrix<K>& C, K beta)
+{
+    if (beta == K(1))
+        return;
+    for (size_t i = 0; i < C.getRows(); ++i) {
+        K* c = C[i].data();
+        for (size_t j = 0; j < C[i].size(); ++j)
+            c[j] = beta == K(0) ? K(0) : beta * c[j];
+    }
+}
+
+/**
+ * @brief C ← alpha·op(A)·op(B) + beta·C, in place
+ *
+ * Kernel per case:
+ *  - op(B) = B: the blocked row-AXPY kernel, op(A) being read element-wise;
+ *  - op(A) = A, op(B) = Bᵀ or Bᴴ: row i of A dotted with row j of B, both contiguous;
+ *  - both transposed: KC x p panels of op(B) are packed into a per-thread
+ *    buffer, then the blocked kernel runs on the panel.
+ * Rows of C are split over threads.
+ *
+ * @param C Result, must be sized rows(op(A)) x cols(op(B)) and not alias A or B.
+ *          An empty C is allocated (beta is then irrelevant).
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If the matrix sizes don't match
+ */
+template <typename K>
+void gemm(K alpha, const Matrix<K>& A, const Matrix<K>& B, K beta, Matrix<K>& C,
+          Op op_a = Op::NoTrans, Op op_b = Op::NoTrans, size_t threads = 0)
+{
+    size_t m = op_a == Op::NoTrans ? A.getRows() : A.getCols();
+    size_t n = op_a == Op::NoTrans ? A.getCols() : A.getRows();
+    size_t n_b = op_b == Op::NoTrans ? B.getRows() : B.getCols();
+    size_t p = op_b == Op::NoTrans ? B.getCols() : B.getRows();
+    if (n != n_b)
+        throw std::invalid_argument("The matrix sizes don't match.");
+    if (C.getRows() == 0)
+        C = Matrix<K>(std::vector<std::vector<K>>(m, std::vector<K>(p)));
+    if (C.getRows() != m || C.getCols() != p)
+        throw std::invalid_argument("The matrix sizes don't match.");
+
+    scale_rows(C, beta);
+    if (alpha == K(0) || n == 0)
+        return;
+
+    auto a = [&A, op_a](size_t i, size_t k) { return op_elem(A, op_a, i, k); };
+    auto c = [&C](size_t i) { return C[i].data(); };
+    if (op_b == Op::NoTrans) {
+        parallel_for(0, m, GEMM_GRAIN, [&](size_t lo, size_t hi) {
+            gemm_kernel(lo, hi, n, p, alpha, a, [&B](size_t k) { return B[k].data(); }, c);
+        }, threads);
+    } else if (op_a == Op::NoTrans) {
+        bool conj_b = op_b == Op::ConjTrans;
+        parallel_for(0, m, GEMM_GRAIN, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                const K* ai = A[i].data();
+                K* ci = C[i].data();
+                for (size_t j = 0; j < p; ++j) {
+                    const K* bj = B[j].data();
+                    K sum = conj_b ? reduce_sum<K>(n, [ai, bj](size_t k) { return ai[k] * conjugate(bj[k]); })
+                                   : reduce_sum<K>(n, [ai, bj](size_t k) { return ai[k] * bj[k]; });
+                    ci[j] += alpha * sum;
+                }
+            }
+        }, threads);
+    } else {
+        parallel_for(0, m, GEMM_GRAIN, [&](size_t lo, size_t hi) {
+            std::vector<K> panel(std::min(GEMM_KC, n) * p);
+            for (size_t k0 = 0; k0 < n; k0 += GEMM_KC) {
+                size_t nk = std::min(GEMM_KC, n - k0);
+                for (size_t k = 0; k < nk; ++k)
+                    for (size_t j = 0; j < p; ++j)
+                        panel[k * p + j] = op_elem(B, op_b, k0 + k, j);
+                gemm_kernel(lo, hi, nk, p, alpha,
+                            [&a, k0](size_t i, size_t k) { return a(i, k0 + k); },
+                            [&panel, p](size_t k) { return panel.data() + k * p; }, c);
+            }
+        }, threads);
+    }
+}
+
+/**
+ * @brief y ← alpha·op(A)·x + beta·y, in place
+ *
+ * op(A) = A dots every (contiguous) row with x, rows split over threads.
+ * op(A) = Aᵀ or Aᴴ streams the rows of A into y with row AXPYs, each thread
+ * owning a slice of y. Nothing is allocated once y has the right size.
+ *
+ * @param y Result, resized when its size is wrong and beta is 0; must not alias x
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If the sizes don't match
+ */
+template <typename K>
+void gemv(K alpha, const Matrix<K>& A, const Vector<K>& x, K beta, Vector<K>& y,
+          Op op = Op::NoTrans, size_t threads = 0)
+{
+    size_t rows = A.getRows();
+    size_t cols = rows ? A.getCols() : 0;
+    size_t m = op == Op::NoTrans ? rows : cols;
+    size_t n = op == Op::NoTrans ? cols : rows;
+    if (x.getSize() != n)
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    if (y.getSize() != m) {
+        if (beta != K(0))
+            throw std::invalid_argument("The vector size doesn't match the matrix row count.");
+        y.resize(m);
+    }
+
+    const K* px = x.data();
+    K* py = y.data();
+    if (op == Op::NoTrans) {
+        parallel_for(0, m, GEMM_GRAIN, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                const K* ai = A[i].data();
+                K sum = reduce_sum<K>(n, [ai, px](size_t k) { return ai[k] * px[k]; });
+                py[i] = (beta == K(0) ? K(0) : beta * py[i]) + alpha * sum;
+            }
+        }, threads);
+        return;
+    }
+    parallel_for(0, m, GEMM_GRAIN * 16, [&](size_t lo, size_t hi) {
+        for (size_t j = lo; j < hi; ++j)
+            py[j] = beta == K(0) ? K(0) : beta * py[j];
+        for (size_t k = 0; k < n; ++k) {
+            const K* ak = A[k].data();
+            K s = alpha * px[k];
+            if (op == Op::ConjTrans && ScalarTraits<K>::is_complex) {
+                for (size_t j = lo; j < hi; ++j)
+                    py[j] += s * conjugate(ak[j]);
+            } else {
+                row_axpy(py + lo, s, ak + lo, hi - lo);
+            }
+        }
+    }, threads);
+}
+
+/*
+* Symmetric rank-k update (xSYRK / xHERK).
+*
+* AᵀA is symmetric (AᴴA Hermitian), so only one triangle is computed: half
+* the flops of a general product, and A is read in place instead of through a
+* transposed copy. Row i of an upper triangle holds p - i elements, so rows
+* are handed to threads in pairs (i, p-1-i) of equal total length.
+*/
+
+enum class Triangle {
+    Upper,
+    Lower
+};
+
+// Columns [first, last) of row i inside the triangle
+inline void triangle_span(Triangle uplo, size_t i, size_t p, size_t& first, size_t& last)
+{
+    first = uplo == Triangle::Upper ? i : 0;
+    last = uplo == Triangle::Upper ? p : i + 1;
+}
+
+// Runs fn(i) on every row of a p x p triangle, rows paired for balance and split over threads
+template <typename F>
+void for_triangle_rows(size_t p, F fn, size_t threads)
+{
+    parallel_for(0, (p + 1) / 2, GEMM_GRAIN / 2, [&fn, p](size_t lo, size_t hi) {
+        for (size_t r = lo; r < hi; ++r) {
+            fn(r);
+            if (p - 1 - r != r)
+                fn(p - 1 - r);
+        }
+    }, threads);
+}
+
+/**
+ * @brief C ← alpha·op(A)·op(A)ᵀ + beta·C on one triangle of C only
+ *
+ * op = NoTrans gives A·Aᵀ (each element a dot of two contiguous rows of A),
+ * Trans gives AᵀA and ConjTrans AᴴA (each row of A is streamed once per
+ * GEMM_KC block as a rank-1 update of the triangle). The other triangle of C
+ * is left untouched; mirror_triangle() fills it.
+ *
+ * @param C Square result of size rows(op(A)ᵀ); an empty C is allocated
+ * @param uplo Triangle to compute
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If C has the wrong size
+ */
+template <typename K>
+void syrk(K alpha, const Matrix<K>& A, K beta, Matrix<K>& C, Triangle uplo = Triangle::Upper,
+          Op op = Op::Trans, size_t threads = 0)
+{
+    size_t rows = A.getRows();
+    size_t cols = rows ? A.getCols() : 0;
+    size_t p = op == Op::NoTrans ? rows : cols;
+    size_t n = op == Op::NoTrans ? cols : rows;
+    if (C.getRows() == 0)
+        C = Matrix<K>(std::vector<std::vector<K>>(p, std::vector<K>(p)));
+    if (C.getRows() != p || C.getCols() != p)
+        throw std::invalid_argument("The matrix sizes don't match.");
+
+    for_triangle_rows(p, [&](size_t i) {
+        size_t first, last;
+        triangle_span(uplo, i, p, first, last);
+        K* ci = C[i].data();
+        for (size_t j = first; j < last; ++j)
+            ci[j] = beta == K(0) ? K(0) : beta * ci[j];
+    }, threads);
+    if (alpha == K(0) || n == 0)
+        return;
+
+    if (op == Op::NoTrans) {
+        for_triangle_rows(p, [&](size_t i) {
+            size_t first, last;
+            triangle_span(uplo, i, p, first, last);
+            const K* ai = A[i].data();
+            K* ci = C[i].data();
+            for (size_t j = first; j < last; ++j) {
+                const K* aj = A[j].data();
+                ci[j] += alpha * reduce_sum<K>(n, [ai, aj](size_t k) { return ai[k] * aj[k]; });
+            }
+        }, threads);
+        return;
+    }
+    for (size_t k0 = 0; k0 < n; k0 += GEMM_KC) {
+        size_t k1 = std::min(n, k0 + GEMM_KC);
+        for_triangle_rows(p, [&](size_t i) {
+            size_t first, last;
+            triangle_span(uplo, i, p, first, last);
+            K* ci = C[i].data() + first;
+            for (size_t k = k0; k < k1; ++k) {
+                const K* ak = A[k].data();
+                K a = op == Op::ConjTrans ? conjugate(ak[i]) : ak[i];
+                row_axpy(ci, alpha * a, ak + first, last - first);
+            }
+        }, threads);
+    }
+}
+
+/**
+ * @brief Copies one triangle of a square matrix onto the other
+ *
+ * @param uplo The triangle holding the data
+ * @param conj Conjugate the mirrored elements (Hermitian result)
+ */
+template <typename K>
+void mirror_triangle(Matrix<K>& C, Triangle uplo, bool conj = true)
+{
+    for (size_t i = 0; i < C.getRows(); ++i)
+        for (size_t j = i + 1; j < C.getRows(); ++j) {
+            if (uplo == Triangle::Upper)
+                C[j][i] = conj ? conjugate(C[i][j]) : C[i][j];
+            else
+                C[i][j] = conj ? conjugate(C[j][i]) : C[j][i];
+        }
+}
+
+/**
+ * @brief Gram matrix AᴴA (AᵀA for real matrices) without transposing A
+ *
+ * Only the upper triangle is computed by syrk(); with mirror = false the
+ * strict lower triangle is left at zero.
+ *
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ */
+template <typename K>
+Matrix<K> gram(const Matrix<K>& A, bool mirror = true, size_t threads = 0)
+{
+    Matrix<K> C;
+    syrk(K(1), A, K(0), C, Triangle::Upper, Op::ConjTrans, threads);
+    if (mirror)
+        mirror_triangle(C, Triangle::Upper);
+    return C;
+}
+
+/*
+* Triangular solves and products (xTRSV, xTRSM, xTRMM), triangle on the left.
+*
+* op(T) is lower triangular when T is lower and not transposed, or upper and
+* transposed; it is then processed top-down, otherwise bottom-up. TRSM and
+* TRMM update whole rows of B with row AXPYs: the columns of B are
+* independent, so they are split over threads, and each thread walks its
+* columns in slices of TRIANGULAR_NC so the rows of B it touches stay in cache.
+*/
+
+const size_t TRIANGULAR_NC = 256;
+
+enum class Diag {
+    NonUnit,
+    Unit
+};
+
+// True when op(T) is lower triangular
+inline bool op_lower(Triangle uplo, Op op)
+{
+    return (uplo == Triangle::Lower) == (op == Op::NoTrans);
+}
+
+template <typename K>
+void check_triangular(const Matrix<K>& T, size_t rows)
+{
+    if (T.getRows() == 0 || T.getRows() != T.getCols())
+        throw std::invalid_argument("Matrix must be square");
+    if (rows != T.getRows())
+        throw std::invalid_argument("The matrix sizes don't match.");
+}
+
+// Diagonal element i of op(T), throws if it is zero (and not assumed unit)
+template <typename K>
+K triangular_pivot(const Matrix<K>& T, Op op, size_t i)
+{
+    K d = op_elem(T, op, i, i);
+    if (d == K(0))
+        throw std::runtime_error("Triangular matrix is singular");
+    return d;
+}
+
+/**
+ * @brief Solves op(T)·x = b in place (x holds b on entry)
+ *
+ * For op(T) = T every step is a dot with a contiguous row of T; for Tᵀ and
+ * Tᴴ the solved component is eliminated from the rest with a row AXPY.
+ *
+ * @param T Square triangular matrix, the other triangle is ignored
+ * @param diag Unit: the diagonal is assumed to be 1 and not read
+ * @throws std::invalid_argument If T is not square or the sizes don't match
+ * @throws std::runtime_error If a diagonal element is zero
+ */
+template <typename K>
+void trsv(const Matrix<K>& T, Vector<K>& x, Triangle uplo, Op op = Op::NoTrans, Diag diag = Diag::NonUnit)
+{
+    check_triangular(T, x.getSize());
+    size_t n = x.getSize();
+    K* px = x.data();
+    bool lower = op_lower(uplo, op);
+    for (size_t s = 0; s < n; ++s) {
+        size_t i = lower ? s : n - 1 - s;
+        size_t lo = lower ? 0 : i + 1;
+        size_t hi = lower ? i : n;
+        if (op == Op::NoTrans) {
+            const K* ti = T[i].data();
+            px[i] -= reduce_sum<K>(hi - lo, [ti, px, lo](size_t j) { return ti[lo + j] * px[lo + j]; });
+            if (diag == Diag::NonUnit)
+                px[i] /= triangular_pivot(T, op, i);
+        } else {
+            // Component i is final once the earlier columns have been eliminated
+            if (diag == Diag::NonUnit)
+                px[i] /= triangular_pivot(T, op, i);
+            const K* ti = T[i].data();
+            size_t first = lower ? i + 1 : 0;
+            size_t last = lower ? n : i;
+            if (op == Op::ConjTrans && ScalarTraits<K>::is_complex)
+                for (size_t j = first; j < last; ++j)
+                    px[j] -= px[i] * conjugate(ti[j]);
+            else
+                row_axpy(px + first, -px[i], ti + first, last - first);
+        }
+    }
+}
+
+// Runs fn(lo, hi) on slices of at most TRIANGULAR_NC columns of a row-major matrix
+template <typename F>
+void for_column_slices(size_t cols, F fn, size_t threads)
+{
+    parallel_for(0, cols, TRIANGULAR_NC / 4, [&fn](size_t lo, size_t hi) {
+        for (size_t j0 = lo; j0 < hi; j0 += TRIANGULAR_NC)
+            fn(j0, std::min(hi, j0 + TRIANGULAR_NC));
+    }, threads);
+}
+
+/**
+ * @brief B ← alpha·op(T)⁻¹·B, solving op(T)·X = alpha·B for all columns at once
+ *
+ * @param T Square triangular matrix, the other triangle is ignored
+ * @param B Right-hand sides as columns, overwritten with the solution
+ * @param diag Unit: the diagonal is assumed to be 1 and not read
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If T is not square or the sizes don't match
+ * @throws std::runtime_error If a diagonal element is zero
+ */
+template <typename K>
+void trsm(K alpha, const Matrix<K>& T, Matrix<K>& B, Triangle uplo, Op op = Op::NoTrans,
+          Diag diag = Diag::NonUnit, size_t threads = 0)
+{
+    check_triangular(T, B.getRows());
+    size_t n = B.getRows();
+    if (diag == Diag::NonUnit)
+        for (size_t i = 0; i < n; ++i)
+            triangular_pivot(T, op, i);
+    bool lower = op_lower(uplo, op);
+    for_column_slices(B.getCols(), [&](size_t c0, size_t c1) {
+        for (size_t s = 0; s < n; ++s) {
+            size_t i = lower ? s : n - 1 - s;
+            size_t lo = lower ? 0 : i + 1;
+            size_t hi = lower ? i : n;
+            K* bi = B[i].data() + c0;
+            if (alpha != K(1))
+                for (size_t j = 0; j < c1 - c0; ++j)
+                    bi[j] *= alpha;
+            for (size_t k = lo; k < hi; ++k)
+                row_axpy(bi, -op_elem(T, op, i, k), B[k].data() + c0, c1 - c0);
+            if (diag == Diag::NonUnit) {
+                K inv = K(1) / op_elem(T, op, i, i);
+                for (size_t j = 0; j < c1 - c0; ++j)
+                    bi[j] *= inv;
+            }
+        }
+    }, threads);
+}
+
+/**
+ * @brief B ← alpha·op(T)·B in place
+ *
+ * Rows of B are overwritten in an order where every row still needed is
+ * read before it changes: top-down when op(T) is upper, bottom-up when lower.
+ *
+ * @param diag Unit: the diagonal is assumed to be 1 and not read
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If T is not square or the sizes don't match
+ */
+template <typename K>
+void trmm(K alpha, const Matrix<K>& T, Matrix<K>& B, Triangle uplo, Op op = Op::NoTrans,
+          Diag diag = Diag::NonUnit, size_t threads = 0)
+{
+    check_triangular(T, B.getRows());
+    size_t n = B.getRows();
+    bool lower = op_lower(uplo, op);
+    for_column_slices(B.getCols(), [&](size_t c0, size_t c1) {
+        for (size_t s = 0; s < n; ++s) {
+            size_t i = lower ? n - 1 - s : s;
+            size_t lo = lower ? 0 : i + 1;
+            size_t hi = lower ? i : n;
+            K* bi = B[i].data() + c0;
+            K d = diag == Diag::Unit ? alpha : alpha * op_elem(T, op, i, i);
+            for (size_t j = 0; j < c1 - c0; ++j)
+                bi[j] *= d;
+            for (size_t k = lo; k < hi; ++k)
+                row_axpy(bi, alpha * op_elem(T, op, i, k), B[k].data() + c0, c1 - c0);
+        }
+    }, threads);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "blas.hpp"
+#include "matrix.hpp"
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+* Matrix chain products A0·A1·...·An-1.
+*
+* The cost of a chain depends on where the parentheses go: with A 10x1000,
+* B 1000x10 and C 10x1000, (A·B)·C costs 2·10⁵ multiply-adds and A·(B·C)
+* 2·10⁷. plan_chain() finds the cheapest order from the shapes alone with the
+* classic O(n³) dynamic program over sub-chains. multiply_chain() then
+* evaluates that tree with gemm(): an intermediate product goes back to a
+* pool as soon as its parent has consumed it, and later products reuse its
+* row buffers through Matrix::resize(), so at most n - 1 buffers exist.
+*/
+
+/**
+ * @brief Evaluation order chosen for a chain
+ *
+ * Flop counts are 2·m·k·p per m x k by k x p product.
+ */
+struct ChainPlan {
+    std::string order;          // e.g. "((A0·A1)·A2)"
+    double flops = 0;           // estimated cost of `order`
+    double naive_flops = 0;     // cost of the left-to-right order
+    std::vector<size_t> split;  // split[i·n + j]: last factor of the left operand of Ai..Aj
+};
+
+inline std::string chain_order(const ChainPlan& plan, size_t n, size_t i, size_t j)
+{
+    if (i == j)
+        return "A" + std::to_string(i);
+    size_t k = plan.split[i * n + j];
+    return "(" + chain_order(plan, n, i, k) + "·" + chain_order(plan, n, k + 1, j) + ")";
+}
+
+/**
+ * @brief Cheapest parenthesisation of a chain from its shapes
+ *
+ * @param dims n + 1 sizes: factor i is dims[i] x dims[i + 1]
+ * @throws std::invalid_argument If dims describes no factor
+ * @time_complexity O(n³)
+ */
+inline ChainPlan plan_chain(const std::vector<size_t>& dims)
+{
+    if (dims.size() < 2)
+        throw std::invalid_argument("Empty matrix chain");
+    size_t n = dims.size() - 1;
+    ChainPlan plan;
+    plan.split.assign(n * n, 0);
+    std::vector<double> cost(n * n, 0.0);
+    for (size_t len = 2; len <= n; ++len)
+        for (size_t i = 0; i + len <= n; ++i) {
+            size_t j = i + len - 1;
+            double best = std::numeric_limits<double>::infinity();
+            for (size_t k = i; k < j; ++k) {
+                double c = cost[i * n + k] + cost[(k + 1) * n + j]
+                           + 2.0 * double(dims[i]) * double(dims[k + 1]) * double(dims[j + 1]);
+                if (c < best) {
+                    best = c;
+                    plan.split[i * n + j] = k;
+                }
+            }
+            cost[i * n + j] = best;
+        }
+    plan.flops = cost[n - 1];
+    for (size_t k = 1; k < n; ++k)
+        plan.naive_flops += 2.0 * double(dims[0]) * double(dims[k]) * double(dims[k + 1]);
+    plan.order = chain_order(plan, n, 0, n - 1);
+    return plan;
+}
+
+// Product of factors i..j into a pooled buffer; returns the factor itself when i == j
+template <typename K>
+const Matrix<K>* chain_eval(const std::vector<std::reference_wrapper<const Matrix<K>>>& chain,
+                            const ChainPlan& plan, size_t i, size_t j, std::vector<Matrix<K>>& buffers,
+                            std::vector<size_t>& pool, size_t& slot, size_t threads)
+{
+    size_t n = chain.size();
+    if (i == j) {
+        slot = n;
+        return &chain[i].get();
+    }
+    size_t k = plan.split[i * n + j];
+    size_t left_slot, right_slot;
+    const Matrix<K>* left = chain_eval(chain, plan, i, k, buffers, pool, left_slot, threads);
+    const Matrix<K>* right = chain_eval(chain, plan, k + 1, j, buffers, pool, right_slot, threads);
+    slot = pool.back();
+    pool.pop_back();
+    Matrix<K>& C = buffers[slot];
+    C.resize(left->getRows(), right->getCols());
+    gemm(K(1), *left, *right, K(0), C, Op::NoTrans, Op::NoTrans, threads);
+    if (left_slot < n)
+        pool.push_back(left_slot);
+    if (right_slot < n)
+        pool.push_back(right_slot);
+    return &C;
+}
+
+/**
+ * @brief A0·A1·...·An-1 in the cheapest order found by plan_chain()
+ *
+ * Call as multiply_chain<double>({A, B, C, D}); the factors are not copied.
+ *
+ * @param plan If not null, receives the chosen order and its estimated flops
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If the chain is empty or two neighbours don't conform
+ */
+template <typename K>
+Matrix<K> multiply_chain(const std::vector<std::reference_wrapper<const Matrix<K>>>& chain,
+                         ChainPlan* plan = nullptr, size_t threads = 0)
+{
+    if (chain.empty())
+        throw std::invalid_argument("Empty matrix chain");
+    size_t n = chain.size();
+    std::vector<size_t> dims(n + 1);
+    dims[0] = chain[0].get().getRows();
+    for (size_t i = 0; i < n; ++i) {
+        const Matrix<K>& A = chain[i].get();
+        if (A.getRows() == 0 || A.getRows() != dims[i])
+            throw std::invalid_argument("The matrix sizes don't match.");
+        dims[i + 1] = A.getCols();
+    }
+    ChainPlan chosen = plan_chain(dims);
+    if (plan)
+        *plan = chosen;
+    if (n == 1)
+        return chain[0].get();
+
+    // Slots are handed out from the pool; n - 1 temporaries is the worst case
+    std::vector<Matrix<K>> buffers(n - 1);
+    std::vector<size_t> pool;
+    for (size_t s = n - 1; s-- > 0;)
+        pool.push_back(s);
+    size_t slot;
+    chain_eval(chain, chosen, 0, n - 1, buffers, pool, slot, threads);
+    Matrix<K> result;
+    result.swap(buffers[slot]);
+    return result;
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+/*
+* 16-bit storage types for memory bound workloads.
+*
+* f16 is IEEE 754 binary16 (5 exponent bits, 10 mantissa bits) and bf16 is
+* bfloat16 (the upper half of a float: 8 exponent bits, 7 mantissa bits).
+* Both are storage only: Matrix<f16>/Vector<bf16> halve the memory traffic of
+* f32, and the dot/mul_vec/mul_mat overloads below widen each element to f32
+* as it is loaded and accumulate in f32. Conversions use F16C and AVX2 (or
+* AVX-512F) when the compiler targets them, and a bit exact scalar path
+* (round to nearest even, subnormals, inf and NaN) otherwise.
+*/
+
+inline uint32_t float_bits(float x)
+{
+    uint32_t b;
+    std::memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+inline float bits_float(uint32_t b)
+{
+    float x;
+    std::memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+inline uint16_t float_to_f16_bits(float value)
+{
+    uint32_t x = float_bits(value);
+    uint16_t sign = uint16_t((x >> 16) & 0x8000);
+    uint32_t a = x & 0x7fffffff;
+
+    if (a >= 0x7f800000)                            // inf or NaN (kept quiet)
+        return sign | 0x7c00 | (a > 0x7f800000 ? 0x200 : 0);
+    if (a >= 0x477ff000)                            // >= 65520 rounds to inf
+        return sign | 0x7c00;
+    if (a < 0x38800000) {                           // below the smallest normal
+        if (a < 0x33000000)                         // <= 2^-25 rounds to zero
+            return sign;
+        uint32_t e = a >> 23;
+        uint32_t mant = (a & 0x7fffff) | 0x800000;
+        uint32_t shift = 126 - e;
+        uint32_t res = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (res & 1)))
+            ++res;
+        return sign | uint16_t(res);
+    }
+    uint32_t r = a - (112u << 23);                  // rebias 127 -> 15
+    uint32_t res = r >> 13;
+    uint32_t rem = r & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (res & 1)))
+        ++res;                                      // a carry bumps the exponent, as it should
+    return sign | uint16_t(res);
+}
+
+inline float f16_bits_to_float(uint16_t h)
+{
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+
+    if (exp == 0) {
+        if (mant == 0)
+            return bits_float(sign);
+        exp = 113;                                  // subnormal: normalise the mantissa
+        while (!(mant & 0x400)) {
+            mant <<= 1;
+            --exp;
+        }
+        return bits_float(sign | (exp << 23) | ((mant & 0x3ff) << 13));
+    }
+    if (exp == 31)
+        return bits_float(sign | 0x7f800000 | (mant << 13));
+    return bits_float(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+inline uint16_t float_to_bf16_bits(float value)
+{
+    uint32_t x = float_bits(value);
+    if ((x & 0x7fffffff) > 0x7f800000)
+        return uint16_t((x >> 16) | 0x40);
+    x += 0x7fff + ((x >> 16) & 1);
+    return uint16_t(x >> 16);
+}
+
+inline float bf16_bits_to_float(uint16_t b)
+{
+    return bits_float(uint32_t(b) << 16);
+}
+
+/**
+ * @brief IEEE 754 half precision storage type
+ */
+struct f16 {
+    uint16_t bits;
+
+    f16() : bits(0) {}
+    f16(float value) : bits(float_to_f16_bits(value)) {}
+    operator float() const { return f16_bits_to_float(bits); }
+};
+
+/**
+ * @brief bfloat16 storage type (truncated float exponent range, 8 bit mantissa)
+ */
+struct bf16 {
+    uint16_t bits;
+
+    bf16() : bits(0) {}
+    bf16(float value) : bits(float_to_bf16_bits(value)) {}
+    operator float() const { return bf16_bits_to_float(bits); }
+};
+
+inline std::ostream& operator<<(std::ostream& os, f16 x) { return os << float(x); }
+inline std::ostream& operator<<(std::ostream& os, bf16 x) { return os << float(x); }
+
+inline float to_float(float x) { return x; }
+inline float to_float(f16 x) { return f16_bits_to_float(x.bits); }
+inline float to_float(bf16 x) { return bf16_bits_to_float(x.bits); }
+
+
+/*
+* Widening loads: 8 (AVX2) or 16 (AVX-512F) consecutive elements as floats.
+*/
+
+#if defined(__AVX512F__)
+inline __m512 load16_ps(const float* p) { return _mm512_loadu_ps(p); }
+inline __m512 load16_ps(const f16* p)
+{
+    return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+}
+inline __m512 load16_ps(const bf16* p)
+{
+    __m512i w = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(w, 16));
+}
+#endif
+
+#if defined(__AVX2__) && defined(__F16C__)
+# define HALF_AVX2 1
+inline __m256 load8_ps(const float* p) { return _mm256_loadu_ps(p); }
+inline __m256 load8_ps(const f16* p)
+{
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+inline __m256 load8_ps(const bf16* p)
+{
+    __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(w, 16));
+}
+inline float hsum_ps(__m256 v)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+/**
+ * @brief Σ a[i]·b[i] with each operand widened to f32 on load
+ *
+ * Uses two independent vector accumulators so the adds of consecutive blocks
+ * do not wait on each other.
+ */
+template <typename A, typename B>
+float widening_dot(const A* a, const B* b, size_t n)
+{
+    size_t i = 0;
+    float res = 0;
+#if defined(__AVX512F__)
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(load16_ps(a + i), load16_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(load16_ps(a + i + 16), load16_ps(b + i + 16), acc1);
+    }
+    res += _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+#endif
+#if defined(HALF_AVX2)
+    __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(load8_ps(a + i), load8_ps(b + i)));
+        acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(load8_ps(a + i + 8), load8_ps(b + i + 8)));
+    }
+    res += hsum_ps(_mm256_add_ps(acc2, acc3));
+#endif
+    float s0 = 0, s1 = 0;
+    for (; i + 2 <= n; i += 2) {
+        s0 += to_float(a[i]) * to_float(b[i]);
+        s1 += to_float(a[i + 1]) * to_float(b[i + 1]);
+    }
+    if (i < n)
+        s0 += to_float(a[i]) * to_float(b[i]);
+    return res + s0 + s1;
+}
+
+/**
+ * @brief c[j] += alpha·b[j] with b widened to f32 on load
+ */
+template <typename B>
+void widening_axpy(float alpha, const B* b, float* c, size_t n)
+{
+    size_t j = 0;
+#if defined(__AVX512F__)
+    __m512 va = _mm512_set1_ps(alpha);
+    for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(c + j, _mm512_fmadd_ps(va, load16_ps(b + j), _mm512_loadu_ps(c + j)));
+#endif
+#if defined(HALF_AVX2)
+    __m256 vb = _mm256_set1_ps(alpha);
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(c + j, _mm256_add_ps(_mm256_loadu_ps(c + j), _mm256_mul_ps(vb, load8_ps(b + j))));
+#endif
+    for (; j < n; ++j)
+        c[j] += alpha * to_float(b[j]);
+}
+
+/**
+ * @brief Converts a buffer of f32 to a 16-bit storage type (round to nearest even)
+ */
+inline void convert(const float* src, f16* dst, size_t n)
+{
+    size_t i = 0;
+#if defined(HALF_AVX2)
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; i < n; ++i)
+        dst[i] = f16(src[i]);
+}
+
+inline void convert(const float* src, bf16* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = bf16(src[i]);
+}
+
+/**
+ * @brief Converts a buffer of a 16-bit storage type to f32
+ */
+template <typename H>
+void convert(const H* src, float* dst, size_t n)
+{
+    size_t i = 0;
+#if defined(HALF_AVX2)
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, load8_ps(src + i));
+#endif
+    for (; i < n; ++i)
+        dst[i] = to_float(src[i]);
+}
+
+/**
+ * @brief Converts a matrix between f32 and a 16-bit storage type
+ *
+ * @tparam To The element type of the result (f16, bf16 or f32)
+ * @tparam From The element type of the input (f16, bf16 or f32)
+ * @param A The matrix to convert
+ * @return Matrix<To> The converted copy
+ */
+template <typename To, typename From>
+Matrix<To> convert_matrix(const Matrix<From>& A)
+{
+    std::vector<std::vector<To>> data(A.getRows(), std::vector<To>(A.getCols()));
+    for (size_t i = 0; i < A.getRows(); ++i)
+        convert(A[i].data(), data[i].data(), A.getCols());
+    return Matrix<To>(data);
+}
+
+template <typename To, typename From>
+Vector<To> convert_vector(const Vector<From>& v)
+{
+    std::vector<To> data(v.getSize());
+    convert(v.data(), data.data(), v.getSize());
+    return Vector<To>(data);
+}
+
+
+/*
+* Kernels on 16-bit storage. They mirror the generic dot/mul_vec/mul_mat but
+* return f32 results, since accumulating in 16 bits would lose most of the
+* precision. Being non-template overloads, they are picked over the generic
+* templates for these element types.
+*/
+
+template <typename A, typename B>
+f32 half_dot(const Vector<A>& v, const Vector<B>& u)
+{
+    if (u.getSize() != v.getSize())
+        throw std::invalid_argument("The vectors must have the same size.");
+    return widening_dot(v.data(), u.data(), v.getSize());
+}
+
+template <typename H, typename X>
+Vector<f32> half_mul_vec(const Matrix<H>& M, const Vector<X>& u)
+{
+    if (u.getSize() != M.getCols())
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    std::vector<f32> result(M.getRows());
+    for (size_t i = 0; i < M.getRows(); ++i)
+        result[i] = widening_dot(M[i].data(), u.data(), M.getCols());
+    return Vector<f32>(result);
+}
+
+template <typename H>
+Matrix<f32> half_mul_mat(const Matrix<H>& A, const Matrix<H>& B)
+{
+    if (A.getCols() != B.getRows())
+        throw std::invalid_argument("The matrix sizes don't match.");
+    std::vector<std::vector<f32>> result(A.getRows(), std::vector<f32>(B.getCols(), 0.0f));
+    for (size_t i = 0; i < A.getRows(); ++i) {
+        const H* a = A[i].data();
+        for (size_t k = 0; k < A.getCols(); ++k)
+            widening_axpy(to_float(a[k]), B[k].data(), result[i].data(), B.getCols());
+    }
+    return Matrix<f32>(result);
+}
+
+inline f32 dot(const Vector<f16>& v, const Vector<f16>& u) { return half_dot(v, u); }
+inline f32 dot(const Vector<bf16>& v, const Vector<bf16>& u) { return half_dot(v, u); }
+
+inline Vector<f32> mul_vec(const Matrix<f16>& M, const Vector<f16>& u) { return half_mul_vec(M, u); }
+inline Vector<f32> mul_vec(const Matrix<f16>& M, const Vector<f32>& u) { return half_mul_vec(M, u); }
+inline Vector<f32> mul_vec(const Matrix<bf16>& M, const Vector<bf16>& u) { return half_mul_vec(M, u); }
+inline Vector<f32> mul_vec(const Matrix<bf16>& M, const Vector<f32>& u) { return half_mul_vec(M, u); }
+
+inline Matrix<f32> mul_mat(const Matrix<f16>& A, const Matrix<f16>& B) { return half_mul_mat(A, B); }
+inline Matrix<f32> mul_mat(const Matrix<bf16>& A, const Matrix<bf16>& B) { return half_mul_mat(A, B); }
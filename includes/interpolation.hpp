@@ -0,0 +1,194 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+/*
+* Batched interpolation for animation keyframes.
+*
+* The lerp() overloads of utils.hpp build temporaries for every call. These
+* kernels instead work on caller owned contiguous buffers of `count` elements
+* of `dim` components each (element i occupies [i·dim, (i+1)·dim)): 3 or 4 for
+* vectors, 16 for row-major 4x4 matrices, 4 for quaternions stored (x, y, z, w).
+* Every element has its own interpolation factor t[i] and results are written
+* to `out`, which may alias `a` or `b`. Nothing is allocated.
+*/
+
+/**
+ * @brief out[i] = (1 - t[i])·a[i] + t[i]·b[i] for every element
+ *
+ * For float elements whose size is a multiple of 4 (vec4, mat4) one factor is
+ * broadcast per element and the components are processed 4 (SSE) or 8 (AVX)
+ * at a time; other sizes use a scalar loop.
+ *
+ * @param a Start values, count·dim components
+ * @param b End values, count·dim components
+ * @param t One interpolation factor per element
+ * @param out Destination, count·dim components
+ * @param count Number of elements
+ * @param dim Number of components per element
+ */
+template <typename K>
+void lerp_batch(const K* a, const K* b, const K* t, K* out, size_t count, size_t dim)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<K, float>) {
+        if (dim % 4 == 0) {
+            for (; i < count; ++i) {
+                size_t base = i * dim;
+                size_t c = 0;
+# if defined(__AVX__)
+                __m256 wt8 = _mm256_set1_ps(t[i]);
+                __m256 ws8 = _mm256_set1_ps(1.0f - t[i]);
+                for (; c + 8 <= dim; c += 8) {
+                    __m256 va = _mm256_loadu_ps(a + base + c);
+                    __m256 vb = _mm256_loadu_ps(b + base + c);
+                    _mm256_storeu_ps(out + base + c, _mm256_add_ps(_mm256_mul_ps(ws8, va), _mm256_mul_ps(wt8, vb)));
+                }
+# endif
+                __m128 wt = _mm_set1_ps(t[i]);
+                __m128 ws = _mm_set1_ps(1.0f - t[i]);
+                for (; c < dim; c += 4) {
+                    __m128 va = _mm_loadu_ps(a + base + c);
+                    __m128 vb = _mm_loadu_ps(b + base + c);
+                    _mm_storeu_ps(out + base + c, _mm_add_ps(_mm_mul_ps(ws, va), _mm_mul_ps(wt, vb)));
+                }
+            }
+            return;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        K s = K(1) - t[i];
+        size_t base = i * dim;
+        for (size_t c = 0; c < dim; ++c)
+            out[base + c] = s * a[base + c] + t[i] * b[base + c];
+    }
+}
+
+/**
+ * @brief Batched lerp of row-major 4x4 matrices (16 components per element)
+ */
+template <typename K>
+void lerp_mat4_batch(const K* a, const K* b, const K* t, K* out, size_t count)
+{
+    lerp_batch(a, b, t, out, count, 16);
+}
+
+// Scales a quaternion stored at q to unit length (left untouched if zero)
+template <typename K>
+void quat_normalize(K* q)
+{
+    K len2 = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+    if (len2 > K(0)) {
+        K inv = K(1) / std::sqrt(len2);
+        q[0] *= inv;
+        q[1] *= inv;
+        q[2] *= inv;
+        q[3] *= inv;
+    }
+}
+
+/**
+ * @brief Normalised lerp of unit quaternions along the shortest arc
+ *
+ * b[i] is negated when a[i]·b[i] < 0 so the blend never takes the long way
+ * round (q and -q are the same rotation). Cheaper than slerp, with a slightly
+ * non-uniform angular speed.
+ *
+ * @param a Start quaternions (x, y, z, w), 4·count components
+ * @param b End quaternions, 4·count components
+ * @param t One interpolation factor per quaternion
+ * @param out Destination, 4·count components
+ * @param count Number of quaternions
+ */
+template <typename K>
+void nlerp_batch(const K* a, const K* b, const K* t, K* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const K* qa = a + 4 * i;
+        const K* qb = b + 4 * i;
+        K* q = out + 4 * i;
+        K d = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+        K s = K(1) - t[i];
+        K u = d < K(0) ? -t[i] : t[i];
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<K, float>) {
+            __m128 v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s), _mm_loadu_ps(qa)),
+                                  _mm_mul_ps(_mm_set1_ps(u), _mm_loadu_ps(qb)));
+            __m128 len2 = _mm_mul_ps(v, v);
+            len2 = _mm_add_ps(len2, _mm_shuffle_ps(len2, len2, _MM_SHUFFLE(2, 3, 0, 1)));
+            len2 = _mm_add_ps(len2, _mm_shuffle_ps(len2, len2, _MM_SHUFFLE(1, 0, 3, 2)));
+            if (_mm_cvtss_f32(len2) > 0.0f)
+                v = _mm_div_ps(v, _mm_sqrt_ps(len2));
+            _mm_storeu_ps(q, v);
+            continue;
+        }
+#endif
+        for (size_t c = 0; c < 4; ++c)
+            q[c] = s * qa[c] + u * qb[c];
+        quat_normalize(q);
+    }
+}
+
+/**
+ * @brief Spherical linear interpolation of unit quaternions along the shortest arc
+ *
+ * Constant angular speed: out = sin((1-t)θ)/sin θ · a + sin(tθ)/sin θ · b with
+ * cos θ = |a·b|. When the quaternions are almost parallel (cos θ > 0.9995)
+ * sin θ vanishes and nlerp is used instead, as the two agree there. The two
+ * weights need scalar trigonometry per element; the blend itself is a 4-wide
+ * SIMD multiply-add for float.
+ *
+ * @param a Start quaternions (x, y, z, w), 4·count components
+ * @param b End quaternions, 4·count components
+ * @param t One interpolation factor per quaternion
+ * @param out Destination, 4·count components
+ * @param count Number of quaternions
+ */
+template <typename K>
+void slerp_batch(const K* a, const K* b, const K* t, K* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const K* qa = a + 4 * i;
+        const K* qb = b + 4 * i;
+        K* q = out + 4 * i;
+        K d = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+        K sign = K(1);
+        if (d < K(0)) {
+            d = -d;
+            sign = K(-1);
+        }
+
+        K wa, wb;
+        bool normalize = false;
+        if (d > K(0.9995)) {
+            wa = K(1) - t[i];
+            wb = t[i];
+            normalize = true;
+        } else {
+            K theta = std::acos(d);
+            K inv_sin = K(1) / std::sin(theta);
+            wa = std::sin((K(1) - t[i]) * theta) * inv_sin;
+            wb = std::sin(t[i] * theta) * inv_sin;
+        }
+        wb *= sign;
+
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<K, float>) {
+            _mm_storeu_ps(q, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(wa), _mm_loadu_ps(qa)),
+                                        _mm_mul_ps(_mm_set1_ps(wb), _mm_loadu_ps(qb))));
+            if (normalize)
+                quat_normalize(q);
+            continue;
+        }
+#endif
+        for (size_t c = 0; c < 4; ++c)
+            q[c] = wa * qa[c] + wb * qb[c];
+        if (normalize)
+            quat_normalize(q);
+    }
+}
@@ -0,0 +1,399 @@
+#pragma once
+
+#include "parallel.hpp"
+#include "reduction.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/*
+* Nearest-neighbour search over a collection of same-sized vectors.
+*
+* angle_cos() recomputes both norms for every pair. VectorCollection instead
+* stores all vectors row-major in one buffer, pre-normalised for the cosine
+* metric (so a similarity is a single dot product) and with their squared
+* norms cached for L2 (|q - x|² = |q|² - 2·q·x + |x|²). Queries are scored
+* against tiles of KNN_ROW_TILE rows, four queries at a time so every stored
+* row is loaded once per four dot products (the Q·Xᵀ product of a GEMM). The
+* rows are split over threads, each keeping its own top-k heaps, and the
+* partial results are merged with a partial sort.
+*
+* build_index() adds an optional IVF (inverted file) coarse index: k-means
+* centroids and one list of rows per centroid. search() with nprobe > 0 only
+* scans the lists of the nprobe closest centroids, trading recall for speed.
+*/
+
+enum class Metric {
+    Cosine,
+    L2
+};
+
+/**
+ * @brief Search result: row index in the collection and its score
+ *
+ * The score is the cosine similarity (higher is closer) or the squared L2
+ * distance (lower is closer), depending on the collection metric.
+ */
+template <typename K>
+struct Neighbor {
+    size_t index;
+    K score;
+};
+
+const size_t KNN_ROW_TILE = 256;
+
+/**
+ * @brief out[q·ldo + r] = Q[q]·X[r] for every query q and row r
+ *
+ * @param Q nq queries stored row-major, dim values each
+ * @param X Pointers to the nx rows to score
+ * @param out Scores, one row of at least nx values per query, stride ldo
+ */
+template <typename K>
+void score_tile(const K* Q, size_t nq, const K* const* X, size_t nx, size_t dim, K* out, size_t ldo)
+{
+    size_t q = 0;
+    for (; q + 4 <= nq; q += 4) {
+        const K* q0 = Q + q * dim;
+        const K* q1 = q0 + dim;
+        const K* q2 = q1 + dim;
+        const K* q3 = q2 + dim;
+        for (size_t r = 0; r < nx; ++r) {
+            const K* x = X[r];
+            K s0 = K(0);
+            K s1 = K(0);
+            K s2 = K(0);
+            K s3 = K(0);
+            for (size_t c = 0; c < dim; ++c) {
+                K xc = x[c];
+                s0 += q0[c] * xc;
+                s1 += q1[c] * xc;
+                s2 += q2[c] * xc;
+                s3 += q3[c] * xc;
+            }
+            out[q * ldo + r] = s0;
+            out[(q + 1) * ldo + r] = s1;
+            out[(q + 2) * ldo + r] = s2;
+            out[(q + 3) * ldo + r] = s3;
+        }
+    }
+    for (; q < nq; ++q) {
+        const K* qq = Q + q * dim;
+        for (size_t r = 0; r < nx; ++r) {
+            const K* x = X[r];
+            out[q * ldo + r] = reduce_sum<K>(dim, [qq, x](size_t c) { return qq[c] * x[c]; });
+        }
+    }
+}
+
+/**
+ * @brief Contiguous collection of vectors answering top-k cosine or L2 queries
+ *
+ * @tparam K Floating point element type
+ */
+template <typename K>
+class VectorCollection {
+    public:
+        /**
+         * @param dim Size of every stored vector
+         * @param metric Cosine similarity (vectors are normalised on insertion) or L2 distance
+         */
+        explicit VectorCollection(size_t dim, Metric metric = Metric::Cosine) : _dim(dim), _metric(metric)
+        {
+            if (dim == 0)
+                throw std::invalid_argument("The vector dimension must be positive.");
+        }
+
+        size_t size() const { return _sq_norms.size(); }
+        size_t dim() const { return _dim; }
+        Metric metric() const { return _metric; }
+        bool indexed() const { return !_lists.empty(); }
+
+        // Stored (normalised for Cosine) values of row i
+        const K* row(size_t i) const { return _data.data() + i * _dim; }
+
+        void reserve(size_t n)
+        {
+            _data.reserve(n * _dim);
+            _sq_norms.reserve(n);
+        }
+
+        /**
+         * @brief Appends a vector and returns its index
+         *
+         * If an index has been built the row is added to the list of its
+         * nearest centroid (the centroids are not updated).
+         *
+         * @throws std::invalid_argument If the size doesn't match or, for Cosine, the vector is zero
+         */
+        size_t add(const Vector<K>& v)
+        {
+            if (v.getSize() != _dim)
+                throw std::invalid_argument("The vector size doesn't match the collection dimension.");
+            const K* p = v.data();
+            K sq = reduce_sum<K>(_dim, [p](size_t c) { return p[c] * p[c]; });
+            size_t index = size();
+            if (_metric == Metric::Cosine) {
+                if (sq == K(0))
+                    throw std::invalid_argument("Cannot normalise vector of 0");
+                K inv = K(1) / std::sqrt(sq);
+                for (size_t c = 0; c < _dim; ++c)
+                    _data.push_back(p[c] * inv);
+                sq = K(1);
+            } else {
+                _data.insert(_data.end(), p, p + _dim);
+            }
+            _sq_norms.push_back(sq);
+            if (indexed())
+                _lists[nearest_centroid(row(index))].push_back(index);
+            return index;
+        }
+
+        /**
+         * @brief Builds the IVF coarse index with `lists` k-means centroids
+         *
+         * Centroids start from evenly spaced rows, then `iterations` rounds of
+         * assignment and mean update are run (means are renormalised for
+         * Cosine, a centroid left without rows keeps its previous value).
+         *
+         * @throws std::invalid_argument If lists is 0 or larger than size()
+         */
+        void build_index(size_t lists, size_t iterations = 10, size_t threads = 0)
+        {
+            size_t n = size();
+            if (lists == 0 || lists > n)
+                throw std::invalid_argument("The number of lists must be between 1 and the collection size.");
+            _centroids.assign(lists * _dim, K(0));
+            for (size_t l = 0; l < lists; ++l)
+                std::copy(row(l * n / lists), row(l * n / lists) + _dim, _centroids.begin() + l * _dim);
+            _centroid_sq.resize(lists);
+            _lists.assign(lists, std::vector<size_t>());
+
+            std::vector<size_t> assign(n);
+            std::vector<K> sums(lists * _dim);
+            std::vector<size_t> counts(lists);
+            for (size_t it = 0; it <= iterations; ++it) {
+                for (size_t l = 0; l < lists; ++l) {
+                    const K* cen = _centroids.data() + l * _dim;
+                    _centroid_sq[l] = reduce_sum<K>(_dim, [cen](size_t c) { return cen[c] * cen[c]; });
+                }
+                parallel_for(0, n, KNN_ROW_TILE, [this, &assign](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i)
+                        assign[i] = nearest_centroid(row(i));
+                }, threads);
+                if (it == iterations)
+                    break;
+                std::fill(sums.begin(), sums.end(), K(0));
+                std::fill(counts.begin(), counts.end(), 0);
+                for (size_t i = 0; i < n; ++i) {
+                    K* s = sums.data() + assign[i] * _dim;
+                    const K* x = row(i);
+                    for (size_t c = 0; c < _dim; ++c)
+                        s[c] += x[c];
+                    ++counts[assign[i]];
+                }
+                for (size_t l = 0; l < lists; ++l) {
+                    if (counts[l] == 0)
+                        continue;
+                    const K* s = sums.data() + l * _dim;
+                    K* cen = _centroids.data() + l * _dim;
+                    K scale = K(1) / K(counts[l]);
+                    if (_metric == Metric::Cosine) {
+                        K sq = reduce_sum<K>(_dim, [s](size_t c) { return s[c] * s[c]; });
+                        scale = sq > K(0) ? K(1) / std::sqrt(sq) : K(0);
+                        if (scale == K(0))
+                            continue;
+                    }
+                    for (size_t c = 0; c < _dim; ++c)
+                        cen[c] = s[c] * scale;
+                }
+            }
+            for (size_t i = 0; i < n; ++i)
+                _lists[assign[i]].push_back(i);
+        }
+
+        /**
+         * @brief The k stored vectors closest to the query, closest first
+         *
+         * @param query Vector of dim() values
+         * @param k Number of neighbours (fewer are returned if fewer rows are scanned)
+         * @param nprobe Number of IVF lists to scan, 0 for an exhaustive search
+         * @param threads Maximum number of threads, 0 for hardware_threads()
+         * @throws std::invalid_argument If the query size doesn't match or, for Cosine, it is zero
+         */
+        std::vector<Neighbor<K>> search(const Vector<K>& query, size_t k, size_t nprobe = 0, size_t threads = 0) const
+        {
+            std::vector<K> Q;
+            std::vector<K> q_sq;
+            prepare(std::vector<Vector<K>>{query}, Q, q_sq);
+            if (nprobe == 0 || !indexed())
+                return run(Q, q_sq, nullptr, size(), k, threads)[0];
+
+            std::vector<size_t> ids;
+            for (size_t l : closest_lists(Q.data(), q_sq[0], nprobe))
+                ids.insert(ids.end(), _lists[l].begin(), _lists[l].end());
+            return run(Q, q_sq, ids.data(), ids.size(), k, threads)[0];
+        }
+
+        /**
+         * @brief Exhaustive top-k search for several queries in one pass over the collection
+         *
+         * @return One result list per query, closest first
+         */
+        std::vector<std::vector<Neighbor<K>>> search_batch(const std::vector<Vector<K>>& queries, size_t k,
+                                                           size_t threads = 0) const
+        {
+            std::vector<K> Q;
+            std::vector<K> q_sq;
+            prepare(queries, Q, q_sq);
+            return run(Q, q_sq, nullptr, size(), k, threads);
+        }
+
+    private:
+        size_t _dim;
+        Metric _metric;
+        std::vector<K> _data;
+        std::vector<K> _sq_norms;
+        std::vector<K> _centroids;
+        std::vector<K> _centroid_sq;
+        std::vector<std::vector<size_t>> _lists;
+
+        // Strict ordering: a is closer than b, ties broken by the lower index
+        bool closer(const Neighbor<K>& a, const Neighbor<K>& b) const
+        {
+            if (a.score != b.score)
+                return _metric == Metric::Cosine ? a.score > b.score : a.score < b.score;
+            return a.index < b.index;
+        }
+
+        // Similarity or squared distance from the dot product of a query and a row
+        K score(K dot, K q_sq, K x_sq) const
+        {
+            if (_metric == Metric::Cosine)
+                return dot;
+            return std::max(K(0), q_sq - K(2) * dot + x_sq);
+        }
+
+        // Copies the queries row-major (normalised for Cosine) and their squared norms
+        void prepare(const std::vector<Vector<K>>& queries, std::vector<K>& Q, std::vector<K>& q_sq) const
+        {
+            Q.resize(queries.size() * _dim);
+            q_sq.resize(queries.size());
+            for (size_t q = 0; q < queries.size(); ++q) {
+                if (queries[q].getSize() != _dim)
+                    throw std::invalid_argument("The vector size doesn't match the collection dimension.");
+                const K* p = queries[q].data();
+                K sq = reduce_sum<K>(_dim, [p](size_t c) { return p[c] * p[c]; });
+                K scale = K(1);
+                if (_metric == Metric::Cosine) {
+                    if (sq == K(0))
+                        throw std::invalid_argument("Cannot normalise vector of 0");
+                    scale = K(1) / std::sqrt(sq);
+                    sq = K(1);
+                }
+                for (size_t c = 0; c < _dim; ++c)
+                    Q[q * _dim + c] = p[c] * scale;
+                q_sq[q] = sq;
+            }
+        }
+
+        // Index of the centroid closest to x (dim values)
+        size_t nearest_centroid(const K* x) const
+        {
+            size_t lists = _centroids.size() / _dim;
+            size_t best = 0;
+            K best_key = K(0);
+            for (size_t l = 0; l < lists; ++l) {
+                const K* cen = _centroids.data() + l * _dim;
+                K d = reduce_sum<K>(_dim, [x, cen](size_t c) { return x[c] * cen[c]; });
+                // |x|² is the same for every centroid and can be left out
+                K key = _metric == Metric::Cosine ? -d : _centroid_sq[l] - K(2) * d;
+                if (l == 0 || key < best_key) {
+                    best = l;
+                    best_key = key;
+                }
+            }
+            return best;
+        }
+
+        // The nprobe lists whose centroids are closest to the prepared query q
+        std::vector<size_t> closest_lists(const K* q, K q_sq, size_t nprobe) const
+        {
+            size_t lists = _lists.size();
+            std::vector<Neighbor<K>> order(lists);
+            for (size_t l = 0; l < lists; ++l) {
+                const K* cen = _centroids.data() + l * _dim;
+                K d = reduce_sum<K>(_dim, [q, cen](size_t c) { return q[c] * cen[c]; });
+                order[l] = Neighbor<K>{l, score(d, q_sq, _centroid_sq[l])};
+            }
+            nprobe = std::min(nprobe, lists);
+            std::partial_sort(order.begin(), order.begin() + nprobe, order.end(),
+                              [this](const Neighbor<K>& a, const Neighbor<K>& b) { return closer(a, b); });
+            std::vector<size_t> result(nprobe);
+            for (size_t i = 0; i < nprobe; ++i)
+                result[i] = order[i].index;
+            return result;
+        }
+
+        // Scores every query against rows [lo, hi) (of ids when not null) into per-query top-k heaps
+        void scan(const std::vector<K>& Q, const std::vector<K>& q_sq, const size_t* ids, size_t lo, size_t hi,
+                  size_t k, std::vector<std::vector<Neighbor<K>>>& heaps) const
+        {
+            size_t nq = q_sq.size();
+            auto cmp = [this](const Neighbor<K>& a, const Neighbor<K>& b) { return closer(a, b); };
+            std::vector<const K*> rows(KNN_ROW_TILE);
+            std::vector<K> scores(nq * KNN_ROW_TILE);
+            for (size_t t = lo; t < hi; t += KNN_ROW_TILE) {
+                size_t nx = std::min(KNN_ROW_TILE, hi - t);
+                for (size_t r = 0; r < nx; ++r)
+                    rows[r] = row(ids ? ids[t + r] : t + r);
+                score_tile(Q.data(), nq, rows.data(), nx, _dim, scores.data(), KNN_ROW_TILE);
+                for (size_t q = 0; q < nq; ++q) {
+                    std::vector<Neighbor<K>>& heap = heaps[q];
+                    for (size_t r = 0; r < nx; ++r) {
+                        size_t index = ids ? ids[t + r] : t + r;
+                        Neighbor<K> cand{index, score(scores[q * KNN_ROW_TILE + r], q_sq[q], _sq_norms[index])};
+                        if (heap.size() < k) {
+                            heap.push_back(cand);
+                            std::push_heap(heap.begin(), heap.end(), cmp);
+                        } else if (closer(cand, heap.front())) {
+                            std::pop_heap(heap.begin(), heap.end(), cmp);
+                            heap.back() = cand;
+                            std::push_heap(heap.begin(), heap.end(), cmp);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Splits the scanned rows over threads, then merges the per-block heaps
+        std::vector<std::vector<Neighbor<K>>> run(const std::vector<K>& Q, const std::vector<K>& q_sq,
+                                                  const size_t* ids, size_t count, size_t k, size_t threads) const
+        {
+            size_t nq = q_sq.size();
+            size_t workers = threads ? threads : hardware_threads();
+            size_t blocks = std::max<size_t>(1, std::min(workers, (count + KNN_ROW_TILE - 1) / KNN_ROW_TILE));
+            std::vector<std::vector<std::vector<Neighbor<K>>>> partial(blocks,
+                std::vector<std::vector<Neighbor<K>>>(nq));
+            if (k > 0) {
+                parallel_for(0, blocks, 1, [&](size_t b_lo, size_t b_hi) {
+                    for (size_t b = b_lo; b < b_hi; ++b)
+                        scan(Q, q_sq, ids, count * b / blocks, count * (b + 1) / blocks, k, partial[b]);
+                }, threads);
+            }
+
+            std::vector<std::vector<Neighbor<K>>> result(nq);
+            auto cmp = [this](const Neighbor<K>& a, const Neighbor<K>& b) { return closer(a, b); };
+            for (size_t q = 0; q < nq; ++q) {
+                std::vector<Neighbor<K>>& out = result[q];
+                for (size_t b = 0; b < blocks; ++b)
+                    out.insert(out.end(), partial[b][q].begin(), partial[b][q].end());
+                size_t keep = std::min(k, out.size());
+                std::partial_sort(out.begin(), out.begin() + keep, out.end(), cmp);
+                out.resize(keep);
+            }
+            return result;
+        }
+};
@@ -0,0 +1,1249 @@
+#pragma once
+
+#include "blas.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include "utils.hpp"
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Converts every element of a matrix to another scalar type
+ *
+ * @tparam To The element type of the result
+ * @tparam From The element type of the input
+ * @param A The matrix to convert
+ * @return Matrix<To> The converted copy
+ */
+template <typename To, typename From>
+Matrix<To> matrix_cast(const Matrix<From>& A)
+{
+    std::vector<std::vector<To>> data(A.getRows(), std::vector<To>(A.getCols()));
+    for (size_t i = 0; i < A.getRows(); ++i) {
+        const From* src = A[i].data();
+        for (size_t j = 0; j < A.getCols(); ++j)
+            data[i][j] = To(src[j]);
+    }
+    return Matrix<To>(data);
+}
+
+/**
+ * @brief Converts every element of a vector to another scalar type
+ */
+template <typename To, typename From>
+Vector<To> vector_cast(const Vector<From>& v)
+{
+    std::vector<To> data(v.getSize());
+    const From* src = v.data();
+    for (size_t i = 0; i < v.getSize(); ++i)
+        data[i] = To(src[i]);
+    return Vector<To>(data);
+}
+
+
+/**
+ * @brief Sign and logarithm of |det A|, which neither overflows nor underflows
+ *
+ * det A = sign·exp(logabs). For a complex K the sign is a unit modulus
+ * complex number. A singular matrix gives sign 0 and logabs -inf.
+ */
+template <typename K>
+struct SlogDet {
+    K sign;
+    real_t<K> logabs;
+};
+
+const size_t LU_BLOCK = 64;
+
+/**
+ * @brief LU factorisation with partial pivoting: P·A = L·U
+ *
+ * L (unit lower triangular, diagonal not stored) and U share one n x n matrix.
+ * Row exchanges swap the row buffers instead of copying elements, and the
+ * factorisation can be reused for any number of right hand sides.
+ *
+ * The elimination is blocked (right-looking, LU_BLOCK columns per panel):
+ * a panel is factorised column by column, the block row of U is obtained by
+ * forward substitution, and the trailing matrix gets the rank-LU_BLOCK
+ * update A22 -= L21·U12 through the blocked GEMM kernel, rows split over
+ * threads. That update holds almost all of the O(n³) work.
+ */
+template <typename K>
+class LU {
+
+    private :
+        Matrix<K> _lu;
+        std::vector<size_t> _perm;  // row i of P·A is row _perm[i] of A
+        int _sign;                  // determinant of P
+        real_t<K> _tol;             // pivots at or below this are singular
+
+        // 1e-10 relative to the largest entry of A, so scaling A does not change the outcome
+        static real_t<K> pivot_tolerance(const Matrix<K>& A)
+        {
+            real_t<K> scale = 0;
+            for (size_t i = 0; i < A.getRows(); ++i)
+                for (const K& a : A[i])
+                    scale = std::max(scale, magnitude(a));
+            return real_t<K>(1e-10) * scale;
+        }
+
+        // Partial pivoting elimination of columns from..n-1; the first columns are already factorised
+        static void eliminate(Matrix<K>& lu, std::vector<size_t>& perm, int& sign, real_t<K> tol,
+                              size_t from, size_t threads)
+        {
+            size_t n = perm.size();
+            for (size_t k0 = from; k0 < n; k0 += LU_BLOCK) {
+                size_t k1 = std::min(n, k0 + LU_BLOCK);
+                // Panel: columns k0..k1-1 only, the swaps still exchange whole rows
+                for (size_t k = k0; k < k1; ++k) {
+                    size_t p = k;
+                    for (size_t i = k + 1; i < n; ++i)
+                        if (magnitude(lu[i][k]) > magnitude(lu[p][k]))
+                            p = i;
+                    if (!(magnitude(lu[p][k]) > tol))
+                        throw std::runtime_error("Matrix is singular and cannot be inverted");
+                    if (p != k) {
+                        std::swap(lu[p], lu[k]);
+                        std::swap(perm[p], perm[k]);
+                        sign = -sign;
+                    }
+
+                    const K* pivot_row = lu[k].data();
+                    K pivot = pivot_row[k];
+                    for (size_t i = k + 1; i < n; ++i) {
+                        K* row = lu[i].data();
+                        K l = row[k] / pivot;
+                        row[k] = l;
+                        if (l == K(0))
+                            continue;
+                        for (size_t j = k + 1; j < k1; ++j)
+                            row[j] -= l * pivot_row[j];
+                    }
+                }
+                if (k1 == n)
+                    break;
+
+                // U12 = L11⁻¹·A12
+                for (size_t i = k0 + 1; i < k1; ++i)
+                    for (size_t c = k0; c < i; ++c)
+                        row_axpy(lu[i].data() + k1, -lu[i][c], lu[c].data() + k1, n - k1);
+                // A22 -= L21·U12
+                parallel_for(k1, n, GEMM_GRAIN, [&lu, k0, k1, n](size_t lo, size_t hi) {
+                    gemm_kernel(lo, hi, k1 - k0, n - k1, K(-1),
+                                [&lu, k0](size_t i, size_t k) { return lu[i][k0 + k]; },
+                                [&lu, k0, k1](size_t k) { return lu[k0 + k].data() + k1; },
+                                [&lu, k1](size_t i) { return lu[i].data() + k1; });
+                }, threads);
+            }
+        }
+
+    public:
+        /**
+         * @brief Factorises A
+         * @param A A square matrix
+         * @param threads Maximum number of threads, 0 for hardware_threads()
+         * @throws std::invalid_argument If A is not square
+         * @throws std::runtime_error If A is singular
+         *
+         * @note A is singular when a pivot is at most 1e-10·max|aij|: relative to the
+         *       scale of A like the 4x4 inverse(), so 1e-12·A factorises whenever A does
+         * @time_complexity O(n³)
+         */
+        explicit LU(const Matrix<K>& A, size_t threads = 0) : _lu(A), _perm(A.getRows()), _sign(1),
+                                                            _tol(pivot_tolerance(A))
+        {
+            if (A.getCols() != A.getRows())
+                throw std::invalid_argument("Matrix must be square");
+            size_t n = A.getRows();
+            for (size_t i = 0; i < n; ++i)
+                _perm[i] = i;
+            eliminate(_lu, _perm, _sign, _tol, 0, threads);
+        }
+
+        size_t size() const { return _perm.size(); }
+        const Matrix<K>& factors() const { return _lu; }
+        const std::vector<size_t>& permutation() const { return _perm; }
+        int sign() const { return _sign; }
+
+        /**
+         * @brief det A as sign and log-magnitude, from the diagonal of U: O(n)
+         */
+        SlogDet<K> slogdet() const
+        {
+            K sign = K(_sign);
+            double logabs = 0;
+            for (size_t i = 0; i < size(); ++i) {
+                K u = _lu[i][i];
+                real_t<K> m = magnitude(u);
+                sign *= u / K(m);
+                logabs += std::log(double(m));
+            }
+            if (ScalarTraits<K>::is_complex)
+                sign /= K(magnitude(sign));
+            return {sign, real_t<K>(logabs)};
+        }
+
+        /**
+         * @brief Solves A·x = b into an existing vector (no allocation once x is sized)
+         * @param b The right hand side
+         * @param x The solution, resized if needed (must not alias b)
+         * @throws std::invalid_argument If b does not have n elements
+         */
+        void solve(const Vector<K>& b, Vector<K>& x) const
+        {
+            size_t n = size();
+            if (b.getSize() != n)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            if (x.getSize() != n)
+                x.resize(n);
+            const K* pb = b.data();
+            K* px = x.data();
+            for (size_t i = 0; i < n; ++i)
+                px[i] = pb[_perm[i]];
+            trsv(_lu, x, Triangle::Lower, Op::NoTrans, Diag::Unit);
+            trsv(_lu, x, Triangle::Upper, Op::NoTrans, Diag::NonUnit);
+        }
+
+        Vector<K> solve(const Vector<K>& b) const
+        {
+            Vector<K> x;
+            solve(b, x);
+            return x;
+        }
+
+        /**
+         * @brief Overwrites B with A⁻¹·B, all columns solved at once with trsm()
+         * @throws std::invalid_argument If B does not have n rows
+         */
+        void solve(Matrix<K>& B) const
+        {
+            if (B.getRows() != size())
+                throw std::invalid_argument("The matrix sizes don't match.");
+            Matrix<K> permuted(B);
+            for (size_t i = 0; i < size(); ++i)
+                B[i] = permuted[_perm[i]];
+            trsm(K(1), _lu, B, Triangle::Lower, Op::NoTrans, Diag::Unit);
+            trsm(K(1), _lu, B, Triangle::Upper, Op::NoTrans, Diag::NonUnit);
+        }
+
+        /**
+         * @brief Grows A by one row and one column: A' = [A c; rᵀ d], in O(n²)
+         *
+         * Bordering: with P' = diag(P, 1), L' = [L 0; lᵀ 1] and
+         * U' = [U y; 0 δ] where L·y = P·c, Uᵀ·l = r and δ = d - lᵀy. The new
+         * row is not pivoted against the others.
+         *
+         * @param row The new last row of A (first n entries)
+         * @param col The new last column of A (first n entries)
+         * @param corner The new diagonal element A'[n][n]
+         * @throws std::invalid_argument If row or col does not have n elements
+         * @throws std::runtime_error If A' is singular (the factorisation is unchanged)
+         */
+        void append(const Vector<K>& row, const Vector<K>& col, K corner)
+        {
+            size_t n = size();
+            if (row.getSize() != n || col.getSize() != n)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            Vector<K> y{std::vector<K>(n)};
+            Vector<K> l(row);
+            for (size_t i = 0; i < n; ++i)
+                y[i] = col[_perm[i]];
+            if (n > 0) {
+                trsv(_lu, y, Triangle::Lower, Op::NoTrans, Diag::Unit);
+                trsv(_lu, l, Triangle::Upper, Op::Trans, Diag::NonUnit);
+            }
+            const K* py = y.data();
+            const K* pl = l.data();
+            K delta = corner - reduce_sum<K>(n, [pl, py](size_t i) { return pl[i] * py[i]; });
+            real_t<K> tol = _tol;
+            for (size_t i = 0; i < n; ++i)
+                tol = std::max(tol, real_t<K>(1e-10) * std::max(magnitude(row[i]), magnitude(col[i])));
+            tol = std::max(tol, real_t<K>(1e-10) * magnitude(corner));
+            if (!(magnitude(delta) > tol))
+                throw std::runtime_error("Matrix is singular and cannot be inverted");
+
+            std::vector<std::vector<K>> rows(n + 1);
+            for (size_t i = 0; i < n; ++i) {
+                rows[i].swap(_lu[i]);
+                rows[i].push_back(py[i]);
+            }
+            rows[n].assign(pl, pl + n);
+            rows[n].push_back(delta);
+            Matrix<K> grown;
+            grown.resize(n + 1, 0);
+            for (size_t i = 0; i <= n; ++i)
+                grown[i].swap(rows[i]);
+            _lu.swap(grown);
+            _perm.push_back(n);
+            _tol = tol;
+        }
+
+        /**
+         * @brief Removes row k and column k of A
+         *
+         * The first min(p, k) elimination steps, p being the pivot position of
+         * row k, do not involve the removed row or column and are kept as is:
+         * only the trailing block is rebuilt from the factors and eliminated
+         * again. Removing a late index costs O(n²), an early one up to O(n³).
+         *
+         * @throws std::out_of_range If k >= n
+         * @throws std::runtime_error If the reduced matrix is singular (the factorisation is unchanged)
+         */
+        void remove(size_t k)
+        {
+            size_t n = size();
+            if (k >= n)
+                throw std::out_of_range("Index out of range");
+            size_t p = 0;
+            while (_perm[p] != k)
+                ++p;
+            size_t from = std::min(p, k);
+
+            // Row i, column j of the reduced factor are row old(i), column old(j)
+            auto old_row = [p](size_t i) { return i < p ? i : i + 1; };
+            auto old_col = [k](size_t j) { return j < k ? j : j + 1; };
+            Matrix<K> lu;
+            lu.resize(n - 1, n - 1);
+            for (size_t i = 0; i + 1 < n; ++i) {
+                const K* src = _lu[old_row(i)].data();
+                K* dst = lu[i].data();
+                for (size_t j = 0; j + 1 < n; ++j)
+                    dst[j] = src[old_col(j)];
+            }
+            // Trailing block: what is left of P·A after the first `from` steps, Σ_{c>=from} L[i][c]·U[c][j]
+            for (size_t i = from; i + 1 < n; ++i) {
+                const K* li = _lu[old_row(i)].data();
+                for (size_t j = from; j + 1 < n; ++j) {
+                    size_t oi = old_row(i);
+                    size_t oj = old_col(j);
+                    size_t last = std::min(oi, oj);
+                    K sum = oi <= oj ? _lu[oi][oj] : K(0);
+                    for (size_t c = from; c < last; ++c)
+                        sum += li[c] * _lu[c][oj];
+                    if (oi > oj)
+                        sum += li[oj] * _lu[oj][oj];
+                    lu[i][j] = sum;
+                }
+            }
+
+            std::vector<size_t> perm;
+            perm.reserve(n - 1);
+            for (size_t i = 0; i < n; ++i)
+                if (i != p)
+                    perm.push_back(_perm[i] > k ? _perm[i] - 1 : _perm[i]);
+            int sign = 1;
+            eliminate(lu, perm, sign, _tol, from, 0);
+
+            // Parity of the final permutation from its cycle lengths
+            std::vector<bool> seen(perm.size());
+            sign = 1;
+            for (size_t i = 0; i < perm.size(); ++i) {
+                size_t length = 0;
+                for (size_t j = i; !seen[j]; j = perm[j], ++length)
+                    seen[j] = true;
+                if (length && length % 2 == 0)
+                    sign = -sign;
+            }
+            _lu.swap(lu);
+            _perm.swap(perm);
+            _sign = sign;
+        }
+};
+
+
+/*
+* Mixed precision iterative refinement.
+*
+* The O(n³) factorisation runs in the low precision type (float by default:
+* twice the SIMD width and half the memory traffic of double) and only the
+* O(n²) residual r = b - A·x and the update x += d are done in K. For
+* matrices whose condition number is well below 1/eps(Low) a handful of
+* refinement steps reaches the accuracy of a K factorisation. When the
+* refinement does not converge the solver falls back to a direct solve in K,
+* as LAPACK's dsgesv does, and reports it.
+*/
+
+enum class SolveMode {
+    Direct,           // LU factorisation and solve in K
+    MixedPrecision    // LU in the low precision type, refinement in K
+};
+
+enum class RefinementStatus {
+    Direct,       // SolveMode::Direct was requested
+    Converged,    // the refinement reached the backward error target
+    FellBack      // the refinement stalled, the result comes from a direct K solve
+};
+
+/**
+ * @brief Report of a solve() or inverse() call with a SolveMode
+ *
+ * `backward_error` is ||b - A·x||∞ / (||A||∞·||x||∞) of the returned solution
+ * (the largest over the columns for inverse()).
+ */
+template <typename K>
+struct RefinementInfo {
+    RefinementStatus status = RefinementStatus::Direct;
+    size_t iterations = 0;
+    real_t<K> backward_error = 0;
+};
+
+// ||A||∞, the largest absolute row sum
+template <typename K>
+real_t<K> matrix_norm_inf(const Matrix<K>& A)
+{
+    real_t<K> res = 0;
+    for (size_t i = 0; i < A.getRows(); ++i) {
+        real_t<K> sum = 0;
+        for (size_t j = 0; j < A.getCols(); ++j)
+            sum += magnitude(A[i][j]);
+        if (sum > res)
+            res = sum;
+    }
+    return res;
+}
+
+// ||A||₁, the largest absolute column sum
+template <typename K>
+real_t<K> matrix_norm_1(const Matrix<K>& A)
+{
+    std::vector<real_t<K>> sums(A.getCols(), 0);
+    for (size_t i = 0; i < A.getRows(); ++i)
+        for (size_t j = 0; j < A.getCols(); ++j)
+            sums[j] += magnitude(A[i][j]);
+    real_t<K> res = 0;
+    for (real_t<K> sum : sums)
+        if (sum > res)
+            res = sum;
+    return res;
+}
+
+// Writes r = b - A·x into r and returns ||r||∞ / (||A||∞·||x||∞)
+template <typename K>
+real_t<K> refinement_residual(const Matrix<K>& A, real_t<K> a_norm, const Vector<K>& b,
+                              const Vector<K>& x, Vector<K>& r)
+{
+    mul_vec(A, x, r);
+    for (size_t i = 0; i < r.getSize(); ++i)
+        r[i] = b[i] - r[i];
+    real_t<K> x_norm = norm_inf(x);
+    if (x_norm == 0 || a_norm == 0)
+        return norm_inf(r);
+    return norm_inf(r) / (a_norm * x_norm);
+}
+
+// Iterative refinement of one right hand side against an existing low precision LU
+template <typename Low, typename K>
+RefinementInfo<K> refine(const Matrix<K>& A, real_t<K> a_norm, const LU<Low>& lu,
+                         const Vector<K>& b, Vector<K>& x, size_t max_iter)
+{
+    const real_t<K> target = std::numeric_limits<real_t<K>>::epsilon()
+                             * std::sqrt(real_t<K>(A.getRows()));
+    size_t n = A.getRows();
+    Vector<K> r{std::vector<K>(n)};
+    Vector<Low> r_low{std::vector<Low>(n)}, d_low{std::vector<Low>(n)};
+    RefinementInfo<K> info;
+
+    for (size_t i = 0; i < n; ++i)
+        r_low[i] = Low(b[i]);
+    lu.solve(r_low, d_low);
+    for (size_t i = 0; i < n; ++i)
+        x[i] = K(d_low[i]);
+
+    info.backward_error = refinement_residual(A, a_norm, b, x, r);
+    while (info.backward_error > target && info.iterations < max_iter) {
+        for (size_t i = 0; i < n; ++i)
+            r_low[i] = Low(r[i]);
+        lu.solve(r_low, d_low);
+        for (size_t i = 0; i < n; ++i)
+            x[i] += K(d_low[i]);
+        ++info.iterations;
+        real_t<K> err = refinement_residual(A, a_norm, b, x, r);
+        // Stop as soon as the correction no longer halves the error
+        bool stalled = err > info.backward_error / 2;
+        info.backward_error = err;
+        if (stalled)
+            break;
+    }
+    info.status = info.backward_error <= target ? RefinementStatus::Converged
+                                                : RefinementStatus::FellBack;
+    return info;
+}
+
+/**
+ * @brief Solves A·x = b with the requested SolveMode
+ *
+ * @tparam Low The factorisation type used by SolveMode::MixedPrecision
+ * @param A A square non-singular matrix
+ * @param b The right hand side
+ * @param x The solution, resized to n
+ * @param mode Direct (LU in K) or MixedPrecision (LU in Low + refinement in K)
+ * @param max_iter Maximum number of refinement steps
+ * @return RefinementInfo<K> How the solution was obtained and its backward error
+ * @throws std::invalid_argument If A is not square or b has the wrong size
+ * @throws std::runtime_error If A is singular
+ */
+template <typename Low = float, typename K>
+RefinementInfo<K> solve(const Matrix<K>& A, const Vector<K>& b, Vector<K>& x,
+                        SolveMode mode = SolveMode::Direct, size_t max_iter = 30)
+{
+    if (A.getCols() != A.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    if (b.getSize() != A.getRows())
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    size_t n = A.getRows();
+    if (x.getSize() != n)
+        x.resize(n);
+    real_t<K> a_norm = matrix_norm_inf(A);
+
+    RefinementInfo<K> info;
+    if (mode == SolveMode::MixedPrecision) {
+        // A matrix singular in Low may still be fine in K: go direct then
+        try {
+            LU<Low> lu(matrix_cast<Low>(A));
+            info = refine(A, a_norm, lu, b, x, max_iter);
+        } catch (const std::runtime_error&) {
+            info.status = RefinementStatus::FellBack;
+        }
+        if (info.status == RefinementStatus::Converged)
+            return info;
+    }
+    LU<K>(A).solve(b, x);
+    Vector<K> r{std::vector<K>(n)};
+    info.backward_error = refinement_residual(A, a_norm, b, x, r);
+    return info;
+}
+
+/**
+ * @brief Computes the inverse of A with the requested SolveMode
+ *
+ * The matrix is factorised once and each column of A⁻¹ is obtained as the
+ * solution of A·x = eⱼ. In MixedPrecision mode every column is refined in K;
+ * if any column fails to converge the whole inverse is recomputed directly.
+ *
+ * @tparam Low The factorisation type used by SolveMode::MixedPrecision
+ * @param A A square non-singular matrix
+ * @param mode Direct or MixedPrecision
+ * @param info If not null, receives the status, the total number of
+ *             refinement steps and the worst column backward error
+ * @return Matrix<K> The inverse of A
+ * @throws std::invalid_argument If A is not square
+ * @throws std::runtime_error If A is singular
+ */
+template <typename Low = float, typename K>
+Matrix<K> inverse(const Matrix<K>& A, SolveMode mode, RefinementInfo<K>* info = nullptr)
+{
+    if (A.getCols() != A.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    size_t n = A.getRows();
+    real_t<K> a_norm = matrix_norm_inf(A);
+    Matrix<K> result(std::vector<std::vector<K>>(n, std::vector<K>(n)));
+    Vector<K> e{std::vector<K>(n)}, x{std::vector<K>(n)}, r{std::vector<K>(n)};
+    RefinementInfo<K> total;
+
+    if (mode == SolveMode::MixedPrecision) {
+        total.status = RefinementStatus::Converged;
+        try {
+            LU<Low> lu(matrix_cast<Low>(A));
+            for (size_t j = 0; j < n && total.status == RefinementStatus::Converged; ++j) {
+                e[j] = K(1);
+                RefinementInfo<K> col = refine(A, a_norm, lu, e, x, 30);
+                e[j] = K(0);
+                total.iterations += col.iterations;
+                total.status = col.status;
+                if (col.backward_error > total.backward_error)
+                    total.backward_error = col.backward_error;
+                for (size_t i = 0; i < n; ++i)
+                    result[i][j] = x[i];
+            }
+        } catch (const std::runtime_error&) {
+            total.status = RefinementStatus::FellBack;
+        }
+        if (info)
+            *info = total;
+        if (total.status == RefinementStatus::Converged)
+            return result;
+        total.backward_error = 0;
+    }
+
+    LU<K> lu(A);
+    for (size_t j = 0; j < n; ++j) {
+        e[j] = K(1);
+        lu.solve(e, x);
+        real_t<K> err = refinement_residual(A, a_norm, e, x, r);
+        e[j] = K(0);
+        for (size_t i = 0; i < n; ++i)
+            result[i][j] = x[i];
+        if (err > total.backward_error)
+            total.backward_error = err;
+    }
+    if (info)
+        *info = total;
+    return result;
+}
+
+
+/*
+* Matrix power and exponential.
+*
+* Both only multiply through gemm() into preallocated buffers: a product is
+* written into a scratch matrix which is then swapped (O(1)) with its
+* destination, so the number of allocations does not depend on k or on the
+* number of squarings.
+*/
+
+template <typename K>
+Matrix<K> identity_matrix(size_t n)
+{
+    Matrix<K> I(std::vector<std::vector<K>>(n, std::vector<K>(n)));
+    for (size_t i = 0; i < n; ++i)
+        I[i][i] = K(1);
+    return I;
+}
+
+/**
+ * @brief A^k by binary exponentiation: O(log k) products
+ *
+ * Three n x n buffers (result, running square, scratch) are allocated
+ * whatever k is.
+ *
+ * @throws std::invalid_argument If A is not square
+ */
+template <typename K>
+Matrix<K> pow(const Matrix<K>& A, size_t k)
+{
+    if (A.getRows() == 0 || A.getCols() != A.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    size_t n = A.getRows();
+    Matrix<K> result = identity_matrix<K>(n);
+    Matrix<K> square(A);
+    Matrix<K> scratch(std::vector<std::vector<K>>(n, std::vector<K>(n)));
+    bool first = true;
+    while (k > 0) {
+        if (k & 1) {
+            if (first) {
+                result = square;
+                first = false;
+            } else {
+                gemm(K(1), result, square, K(0), scratch);
+                result.swap(scratch);
+            }
+        }
+        k >>= 1;
+        if (k > 0) {
+            gemm(K(1), square, square, K(0), scratch);
+            square.swap(scratch);
+        }
+    }
+    return result;
+}
+
+// M += a·X for matrices of the same size
+template <typename K>
+void add_scaled(Matrix<K>& M, K a, const Matrix<K>& X)
+{
+    for (size_t i = 0; i < M.getRows(); ++i)
+        row_axpy(M[i].data(), a, X[i].data(), M.getCols());
+}
+
+/**
+ * @brief Matrix exponential e^A by scaling and squaring with a Padé approximant
+ *
+ * Follows Higham (2005): the smallest Padé degree m in {3, 5, 7, 9, 13}
+ * whose ||A||₁ threshold θm holds is used; above θ13, A is scaled by 2^-s
+ * so that ||A/2^s||₁ <= θ13 and the result is squared s times. The
+ * approximant is r(A) = (V - U)⁻¹(V + U) with U the odd and V the even part
+ * of the Padé numerator, solved with one LU factorisation. The thresholds
+ * are the double precision ones, which are conservative for float.
+ *
+ * @throws std::invalid_argument If A is not square
+ */
+template <typename K>
+Matrix<K> expm(const Matrix<K>& A)
+{
+    if (A.getRows() == 0 || A.getCols() != A.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    using R = real_t<K>;
+    static const double theta[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                                   2.097847961257068e0, 5.371920351148152e0};
+    static const double b3[] = {120, 60, 12, 1};
+    static const double b5[] = {30240, 15120, 3360, 420, 30, 1};
+    static const double b7[] = {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+    static const double b9[] = {17643225600., 8821612800., 2075673600., 302702400., 30270240.,
+                                2162160., 110880., 3960., 90., 1.};
+    static const double b13[] = {64764752532480000., 32382376266240000., 7771770303897600.,
+                                 1187353796428800., 129060195264000., 10559470521600.,
+                                 670442572800., 33522128640., 1323241920., 40840800., 960960.,
+                                 16380., 182., 1.};
+    static const double* coefs[] = {b3, b5, b7, b9};
+
+    size_t n = A.getRows();
+    R a_norm = matrix_norm_1(A);
+    size_t degree = 0;
+    while (degree < 4 && double(a_norm) > theta[degree])
+        ++degree;
+    size_t s = 0;
+    Matrix<K> As(A);
+    if (degree == 4 && double(a_norm) > theta[4]) {
+        s = size_t(std::ceil(std::log2(double(a_norm) / theta[4])));
+        K scale = K(std::ldexp(1.0, -int(s)));
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                As[i][j] *= scale;
+    }
+
+    Matrix<K> zero(std::vector<std::vector<K>>(n, std::vector<K>(n)));
+    Matrix<K> A2(zero), A4(zero), A6(zero), U(zero), V(zero), scratch(zero);
+    gemm(K(1), As, As, K(0), A2);
+    if (degree < 4) {
+        // U = A·Σ b(2j+1)·A^2j, V = Σ b(2j)·A^2j, the even powers built one by one
+        const double* b = coefs[degree];
+        size_t m = 2 * degree + 3;
+        Matrix<K> power = identity_matrix<K>(n);
+        for (size_t j = 0; 2 * j <= m; ++j) {
+            if (j > 0) {
+                gemm(K(1), power, A2, K(0), scratch);
+                power.swap(scratch);
+            }
+            add_scaled(U, K(R(b[2 * j + 1])), power);
+            add_scaled(V, K(R(b[2 * j])), power);
+        }
+        gemm(K(1), As, U, K(0), scratch);
+        U.swap(scratch);
+    } else {
+        const double* b = b13;
+        gemm(K(1), A2, A2, K(0), A4);
+        gemm(K(1), A4, A2, K(0), A6);
+        // U = A·(A6·(b13·A6 + b11·A4 + b9·A2) + b7·A6 + b5·A4 + b3·A2 + b1·I)
+        Matrix<K> inner(zero);
+        add_scaled(inner, K(R(b[13])), A6);
+        add_scaled(inner, K(R(b[11])), A4);
+        add_scaled(inner, K(R(b[9])), A2);
+        gemm(K(1), A6, inner, K(0), U);
+        add_scaled(U, K(R(b[7])), A6);
+        add_scaled(U, K(R(b[5])), A4);
+        add_scaled(U, K(R(b[3])), A2);
+        for (size_t i = 0; i < n; ++i)
+            U[i][i] += K(R(b[1]));
+        gemm(K(1), As, U, K(0), scratch);
+        U.swap(scratch);
+        // V = A6·(b12·A6 + b10·A4 + b8·A2) + b6·A6 + b4·A4 + b2·A2 + b0·I
+        inner = zero;
+        add_scaled(inner, K(R(b[12])), A6);
+        add_scaled(inner, K(R(b[10])), A4);
+        add_scaled(inner, K(R(b[8])), A2);
+        gemm(K(1), A6, inner, K(0), V);
+        add_scaled(V, K(R(b[6])), A6);
+        add_scaled(V, K(R(b[4])), A4);
+        add_scaled(V, K(R(b[2])), A2);
+        for (size_t i = 0; i < n; ++i)
+            V[i][i] += K(R(b[0]));
+    }
+
+    // P = V + U into U, Q = V - U = 2V - P into V, then U ← Q⁻¹·P
+    add_scaled(U, K(1), V);
+    add_scaled(V, K(1), V);
+    add_scaled(V, K(-1), U);
+    LU<K>(V).solve(U);
+    for (size_t i = 0; i < s; ++i) {
+        gemm(K(1), U, U, K(0), scratch);
+        U.swap(scratch);
+    }
+    return U;
+}
+
+/*
+* Low-rank updates of an explicit inverse.
+*
+* When A changes by a rank-k term, Sherman-Morrison (k = 1) and Woodbury give
+* the new inverse from the old one in O(n²·k) instead of O(n³):
+*   (A + u·vᵀ)⁻¹ = A⁻¹ - (A⁻¹u)(vᵀA⁻¹) / (1 + vᵀA⁻¹u)
+*   (A + U·Vᵀ)⁻¹ = A⁻¹ - (A⁻¹U)(I + VᵀA⁻¹U)⁻¹(VᵀA⁻¹)
+* The denominator 1 + vᵀA⁻¹u (the k x k capacitance matrix for Woodbury) is
+* det(A + u·vᵀ)/det(A): when it nearly vanishes the updated matrix is close to
+* singular and the formula loses every significant digit. The updates then
+* return false and leave A⁻¹ untouched, so the caller can re-invert from scratch.
+*/
+
+/**
+ * @brief Ainv ← (A + u·vᵀ)⁻¹ in place, given Ainv = A⁻¹ (Sherman-Morrison)
+ *
+ * Plain transpose, also for complex K: pass conj(v) for a u·vᴴ update.
+ *
+ * @param tol The update is refused when |1 + vᵀA⁻¹u| < tol·(1 + |vᵀA⁻¹u|)
+ * @return false if A + u·vᵀ is numerically singular (Ainv unchanged)
+ * @throws std::invalid_argument If Ainv is not square or u, v have the wrong size
+ * @time_complexity O(n²)
+ */
+template <typename K>
+bool inverse_update_rank1(Matrix<K>& Ainv, const Vector<K>& u, const Vector<K>& v,
+                          real_t<K> tol = real_t<K>(1e-10))
+{
+    if (Ainv.getRows() == 0 || Ainv.getCols() != Ainv.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    size_t n = Ainv.getRows();
+    if (u.getSize() != n || v.getSize() != n)
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+
+    // w = A⁻¹u (a dot per row), z = vᵀA⁻¹ (an AXPY per row)
+    const K* pu = u.data();
+    const K* pv = v.data();
+    std::vector<K> w(n);
+    std::vector<K> z(n);
+    for (size_t i = 0; i < n; ++i) {
+        const K* row = Ainv[i].data();
+        w[i] = reduce_sum<K>(n, [row, pu](size_t j) { return row[j] * pu[j]; });
+        row_axpy(z.data(), pv[i], row, n);
+    }
+    K s = reduce_sum<K>(n, [pv, &w](size_t i) { return pv[i] * w[i]; });
+    K denom = K(1) + s;
+    if (magnitude(denom) < tol * (1 + magnitude(s)))
+        return false;
+    for (size_t i = 0; i < n; ++i)
+        row_axpy(Ainv[i].data(), -w[i] / denom, z.data(), n);
+    return true;
+}
+
+/**
+ * @brief Ainv ← (A + U·Vᵀ)⁻¹ in place, given Ainv = A⁻¹ (Woodbury)
+ *
+ * @param U n x k
+ * @param V n x k
+ * @param threads Maximum number of threads for the gemm() calls, 0 for hardware_threads()
+ * @return false if I + VᵀA⁻¹U is singular to the LU tolerance (Ainv unchanged)
+ * @throws std::invalid_argument If Ainv is not square or U, V have the wrong size
+ * @time_complexity O(n²·k + k³)
+ */
+template <typename K>
+bool inverse_update_woodbury(Matrix<K>& Ainv, const Matrix<K>& U, const Matrix<K>& V, size_t threads = 0)
+{
+    if (Ainv.getRows() == 0 || Ainv.getCols() != Ainv.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    size_t n = Ainv.getRows();
+    if (U.getRows() != n || V.getRows() != n || U.getCols() != V.getCols())
+        throw std::invalid_argument("The matrix sizes don't match.");
+    if (U.getCols() == 0)
+        return true;
+
+    Matrix<K> W;  // A⁻¹U, n x k
+    Matrix<K> Z;  // VᵀA⁻¹, k x n
+    Matrix<K> S;  // I + VᵀA⁻¹U, k x k
+    gemm(K(1), Ainv, U, K(0), W, Op::NoTrans, Op::NoTrans, threads);
+    gemm(K(1), V, Ainv, K(0), Z, Op::Trans, Op::NoTrans, threads);
+    gemm(K(1), Z, U, K(0), S, Op::NoTrans, Op::NoTrans, threads);
+    for (size_t i = 0; i < S.getRows(); ++i)
+        S[i][i] += K(1);
+    try {
+        LU<K>(S).solve(Z);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    gemm(K(-1), W, Z, K(1), Ainv, Op::NoTrans, Op::NoTrans, threads);
+    return true;
+}
+
+/*
+* Cholesky and QR factorisations that follow changes of the matrix.
+*
+* Cholesky::update()/downdate() turn L·Lᴴ into the factor of A ± x·xᴴ with
+* one sweep of plane rotations, O(n²). QR keeps Qᴴ and R explicitly and
+* restores the triangular form of R after a row or column is added or
+* removed with Givens rotations applied to both, O(m·(m + n)) per change:
+* the streaming least squares and active set building blocks. Qᴴ rather than
+* Q is stored so that every rotation combines two contiguous rows.
+*/
+
+/**
+ * @brief Plane rotation G = [c s; -conj(s) c], c real, with G·(a, b)ᵀ = (r, 0)ᵀ
+ */
+template <typename K>
+void givens(const K& a, const K& b, real_t<K>& c, K& s)
+{
+    using R = real_t<K>;
+    if (b == K(0)) {
+        c = R(1);
+        s = K(0);
+        return;
+    }
+    if (a == K(0)) {
+        c = R(0);
+        s = K(1);
+        return;
+    }
+    R abs_a = magnitude(a);
+    R norm = std::hypot(abs_a, magnitude(b));
+    c = abs_a / norm;
+    s = (a / abs_a) * conjugate(b) / norm;
+}
+
+// Applies G to rows i and j of M, columns from `first` on
+template <typename K>
+void rotate_rows(Matrix<K>& M, size_t i, size_t j, real_t<K> c, const K& s, size_t first = 0)
+{
+    K* x = M[i].data();
+    K* y = M[j].data();
+    K sc = conjugate(s);
+    for (size_t col = first; col < M[i].size(); ++col) {
+        K xi = x[col];
+        K yi = y[col];
+        x[col] = c * xi + s * yi;
+        y[col] = c * yi - sc * xi;
+    }
+}
+
+/**
+ * @brief Cholesky factorisation A = L·Lᴴ of a Hermitian positive definite matrix
+ *
+ * Only the lower triangle of A is read.
+ */
+template <typename K>
+class Cholesky {
+
+    private:
+        Matrix<K> _l;  // strict upper triangle kept at zero
+
+    public:
+        /**
+         * @throws std::invalid_argument If A is not square
+         * @throws std::runtime_error If A is not positive definite
+         * @time_complexity O(n³/3)
+         */
+        explicit Cholesky(const Matrix<K>& A) : _l(A)
+        {
+            using R = real_t<K>;
+            if (A.getRows() && A.getCols() != A.getRows())
+                throw std::invalid_argument("Matrix must be square");
+            size_t n = A.getRows();
+            for (size_t j = 0; j < n; ++j) {
+                K* lj = _l[j].data();
+                for (size_t c = j + 1; c < n; ++c)
+                    lj[c] = K(0);
+                R d = ScalarTraits<K>::real(lj[j])
+                      - reduce_sum<R>(j, [lj](size_t c) { return ScalarTraits<K>::real(lj[c] * conjugate(lj[c])); });
+                if (!(d > R(0)))
+                    throw std::runtime_error("Matrix is not positive definite");
+                lj[j] = K(std::sqrt(d));
+                for (size_t i = j + 1; i < n; ++i) {
+                    K* li = _l[i].data();
+                    li[j] = (li[j] - reduce_sum<K>(j, [li, lj](size_t c) { return li[c] * conjugate(lj[c]); })) / lj[j];
+                }
+            }
+        }
+
+        size_t size() const { return _l.getRows(); }
+        const Matrix<K>& factor() const { return _l; }
+
+        /**
+         * @brief det A = Π lᵢᵢ², always positive: sign 1 and 2·Σ log lᵢᵢ, O(n)
+         */
+        SlogDet<K> slogdet() const
+        {
+            double logabs = 0;
+            for (size_t i = 0; i < size(); ++i)
+                logabs += std::log(double(ScalarTraits<K>::real(_l[i][i])));
+            return {K(1), real_t<K>(2 * logabs)};
+        }
+
+        /**
+         * @brief Solves A·x = b into an existing vector (no allocation once x is sized)
+         * @throws std::invalid_argument If b does not have n elements
+         */
+        void solve(const Vector<K>& b, Vector<K>& x) const
+        {
+            if (b.getSize() != size())
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            if (&x != &b)
+                x = b;
+            if (size() == 0)
+                return;
+            trsv(_l, x, Triangle::Lower, Op::NoTrans);
+            trsv(_l, x, Triangle::Lower, Op::ConjTrans);
+        }
+
+        Vector<K> solve(const Vector<K>& b) const
+        {
+            Vector<K> x;
+            solve(b, x);
+            return x;
+        }
+
+        /**
+         * @brief Factor of A + x·xᴴ, in place
+         * @throws std::invalid_argument If x does not have n elements
+         * @time_complexity O(n²)
+         */
+        void update(const Vector<K>& x)
+        {
+            rank1(x, 1);
+        }
+
+        /**
+         * @brief Factor of A - x·xᴴ, in place
+         *
+         * Checked beforehand: A - x·xᴴ is positive definite iff ||L⁻¹x|| < 1.
+         *
+         * @throws std::invalid_argument If x does not have n elements
+         * @throws std::runtime_error If A - x·xᴴ is not positive definite (the factor is unchanged)
+         * @time_complexity O(n²)
+         */
+        void downdate(const Vector<K>& x)
+        {
+            using R = real_t<K>;
+            if (x.getSize() != size())
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            Vector<K> p(x);
+            if (size())
+                trsv(_l, p, Triangle::Lower, Op::NoTrans);
+            const K* pp = p.data();
+            R norm2 = reduce_sum<R>(size(), [pp](size_t i) { return ScalarTraits<K>::real(pp[i] * conjugate(pp[i])); });
+            if (!(norm2 < R(1) - R(1e-10)))
+                throw std::runtime_error("Matrix is not positive definite");
+            rank1(x, -1);
+        }
+
+    private:
+        // L'·L'ᴴ = L·Lᴴ + sigma·x·xᴴ, one column of L per step
+        void rank1(const Vector<K>& x, int sigma)
+        {
+            using R = real_t<K>;
+            size_t n = size();
+            if (x.getSize() != n)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            std::vector<K> w(x.data(), x.data() + n);
+            for (size_t k = 0; k < n; ++k) {
+                R lkk = ScalarTraits<K>::real(_l[k][k]);
+                R xk2 = ScalarTraits<K>::real(w[k] * conjugate(w[k]));
+                R r2 = lkk * lkk + R(sigma) * xk2;
+                if (!(r2 > R(0)))
+                    throw std::runtime_error("Matrix is not positive definite");
+                R r = std::sqrt(r2);
+                K xk = w[k];
+                K xk_conj = conjugate(xk);
+                _l[k][k] = K(r);
+                for (size_t i = k + 1; i < n; ++i) {
+                    K lik = _l[i][k];
+                    _l[i][k] = (lik * lkk + K(R(sigma)) * w[i] * xk_conj) / r;
+                    w[i] = (w[i] * lkk - xk * lik) / r;
+                }
+            }
+        }
+};
+
+/**
+ * @brief QR factorisation A = Q·R of an m x n matrix, Q unitary m x m, R upper trapezoidal
+ *
+ * Built with Givens rotations; rows and columns can then be appended and
+ * removed without refactorising. Q is kept explicitly, so memory is O(m²).
+ */
+template <typename K>
+class QR {
+
+    private:
+        Matrix<K> _qh;  // Qᴴ, m x m
+        Matrix<K> _r;   // m x n
+        size_t _cols;
+
+        // Zeroes R[i][col] against R[i - 1][col] for i from `bottom` down to col + 1
+        void reduce_column(size_t col, size_t bottom)
+        {
+            for (size_t i = bottom; i > col; --i) {
+                real_t<K> c;
+                K s;
+                givens(_r[i - 1][col], _r[i][col], c, s);
+                rotate_rows(_r, i - 1, i, c, s, col);
+                rotate_rows(_qh, i - 1, i, c, s);
+            }
+        }
+
+    public:
+        /**
+         * @time_complexity O(m·n·(m + n))
+         */
+        explicit QR(const Matrix<K>& A) : _r(A), _cols(A.getRows() ? A.getCols() : 0)
+        {
+            size_t m = A.getRows();
+            _qh.resize(m, m);
+            for (size_t i = 0; i < m; ++i)
+                for (size_t j = 0; j < m; ++j)
+                    _qh[i][j] = i == j ? K(1) : K(0);
+            for (size_t j = 0; j < std::min(m, _cols); ++j)
+                reduce_column(j, m - 1);
+        }
+
+        size_t rows() const { return _qh.getRows(); }
+        size_t cols() const { return _cols; }
+        const Matrix<K>& r() const { return _r; }
+        const Matrix<K>& qh() const { return _qh; }
+        Matrix<K> q() const { return conj_transpose(_qh); }
+
+        /**
+         * @brief Adds w as the last row of A
+         * @throws std::invalid_argument If w does not have n elements
+         * @time_complexity O(n·(m + n))
+         */
+        void append_row(const Vector<K>& w)
+        {
+            if (w.getSize() != _cols)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            size_t m = rows();
+            for (size_t i = 0; i < m; ++i)
+                _qh[i].push_back(K(0));
+            _qh.resize(m + 1, m + 1);
+            for (size_t j = 0; j < m; ++j)
+                _qh[m][j] = K(0);
+            _qh[m][m] = K(1);
+            _r.resize(m + 1, _cols);
+            for (size_t j = 0; j < _cols; ++j)
+                _r[m][j] = w[j];
+            // The new row is eliminated against the diagonal of R, left to right
+            for (size_t j = 0; j < std::min(m, _cols); ++j) {
+                real_t<K> c;
+                K s;
+                givens(_r[j][j], _r[m][j], c, s);
+                rotate_rows(_r, j, m, c, s, j);
+                rotate_rows(_qh, j, m, c, s);
+            }
+        }
+
+        /**
+         * @brief Removes row k of A
+         *
+         * Rotations bring column k of Qᴴ to a multiple of e₀, which turns R
+         * upper Hessenberg; dropping the first row of both then leaves the
+         * factorisation of A without row k.
+         *
+         * @throws std::out_of_range If k >= m
+         * @time_complexity O(m·(m + n))
+         */
+        void remove_row(size_t k)
+        {
+            size_t m = rows();
+            if (k >= m)
+                throw std::out_of_range("Index out of range");
+            for (size_t i = m - 1; i > 0; --i) {
+                real_t<K> c;
+                K s;
+                givens(_qh[i - 1][k], _qh[i][k], c, s);
+                rotate_rows(_qh, i - 1, i, c, s);
+                rotate_rows(_r, i - 1, i, c, s, std::min(i - 1, _cols));
+            }
+            Matrix<K> qh;
+            Matrix<K> r;
+            qh.resize(m - 1, m - 1);
+            r.resize(m - 1, _cols);
+            for (size_t i = 1; i < m; ++i) {
+                for (size_t j = 0; j + 1 < m; ++j)
+                    qh[i - 1][j] = _qh[i][j < k ? j : j + 1];
+                r[i - 1].swap(_r[i]);
+            }
+            _qh.swap(qh);
+            _r.swap(r);
+        }
+
+        /**
+         * @brief Adds c as the last column of A
+         * @throws std::invalid_argument If c does not have m elements
+         * @time_complexity O(m²)
+         */
+        void append_col(const Vector<K>& c)
+        {
+            size_t m = rows();
+            if (c.getSize() != m)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            const K* pc = c.data();
+            for (size_t i = 0; i < m; ++i) {
+                const K* q = _qh[i].data();
+                _r[i].push_back(reduce_sum<K>(m, [q, pc](size_t j) { return q[j] * pc[j]; }));
+            }
+            ++_cols;
+            if (m > _cols)
+                reduce_column(_cols - 1, m - 1);
+        }
+
+        /**
+         * @brief Removes column k of A
+         *
+         * Without column k, R is upper Hessenberg from column k on; one
+         * rotation per column restores it.
+         *
+         * @throws std::out_of_range If k >= n
+         * @time_complexity O(m·(m + n))
+         */
+        void remove_col(size_t k)
+        {
+            if (k >= _cols)
+                throw std::out_of_range("Index out of range");
+            for (size_t i = 0; i < rows(); ++i)
+                _r[i].erase(_r[i].begin() + long(k));
+            --_cols;
+            for (size_t j = k; j < _cols && j + 1 < rows(); ++j) {
+                real_t<K> c;
+                K s;
+                givens(_r[j][j], _r[j + 1][j], c, s);
+                rotate_rows(_r, j, j + 1, c, s, j);
+                rotate_rows(_qh, j, j + 1, c, s);
+            }
+        }
+
+        /**
+         * @brief Least squares solution of min ||A·x - b|| for m >= n: R·x = (Qᴴb)[0, n)
+         * @throws std::invalid_argument If b does not have m elements or m < n
+         * @throws std::runtime_error If A is rank deficient: a diagonal entry of R is
+         *         at most 1e-10·max|rij|, which is relative to the scale of A like LU
+         */
+        Vector<K> solve(const Vector<K>& b) const
+        {
+            size_t m = rows();
+            size_t n = _cols;
+            if (m < n)
+                throw std::invalid_argument("Least squares needs at least as many rows as columns");
+            if (b.getSize() != m)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            real_t<K> scale = 0;
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = i; j < n; ++j)
+                    scale = std::max(scale, magnitude(_r[i][j]));
+            real_t<K> tol = real_t<K>(1e-10) * scale;
+            const K* pb = b.data();
+            Vector<K> x{std::vector<K>(n)};
+            K* px = x.data();
+            for (size_t i = 0; i < n; ++i) {
+                const K* q = _qh[i].data();
+                px[i] = reduce_sum<K>(m, [q, pb](size_t j) { return q[j] * pb[j]; });
+            }
+            for (size_t i = n; i-- > 0;) {
+                const K* ri = _r[i].data();
+                if (!(magnitude(ri[i]) > tol))
+                    throw std::runtime_error("Matrix is rank deficient");
+                px[i] -= reduce_sum<K>(n - i - 1, [ri, px, i](size_t j) { return ri[i + 1 + j] * px[i + 1 + j]; });
+                px[i] /= ri[i];
+            }
+            return x;
+        }
+};
+
+/**
+ * @brief Sign and log-magnitude of det A for any size, through LU
+ *
+ * Use LU::slogdet() or Cholesky::slogdet() to reuse a factorisation.
+ *
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @return SlogDet<K> {0, -inf} when A is singular to the LU tolerance (a pivot at
+ *         most 1e-10·max|aij|, so a uniformly tiny A is not mistaken for singular)
+ * @throws std::invalid_argument If A is not square
+ * @time_complexity O(n³)
+ */
+template <typename K>
+SlogDet<K> slogdet(const Matrix<K>& A, size_t threads = 0)
+{
+    if (A.getRows() == 0)
+        return {K(1), real_t<K>(0)};
+    if (A.getCols() != A.getRows())
+        throw std::invalid_argument("Matrix must be square");
+    try {
+        return LU<K>(A, threads).slogdet();
+    } catch (const std::runtime_error&) {
+        return {K(0), -std::numeric_limits<real_t<K>>::infinity()};
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "complex.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+/*
+* Closed-form 4x4 determinant and inverse.
+*
+* Camera and model transforms are 4x4, a size at which the general algorithms
+* are mostly overhead: the cofactor expansion allocated four 3x3 minors and
+* Gauss-Jordan pivots on two full copies. Here the inverse is the adjugate
+* divided by the determinant, both built from the six 2x2 minors of rows 0-1
+* (s) and the six of rows 2-3 (c), with no pivoting and no branch before the
+* final singularity test. With SSE2 the float kernels compute the adjugate a
+* column at a time in one register and transpose it on the way out.
+*
+* Transforms whose last row is exactly (0 0 0 1) are affine: their inverse is
+* [M⁻¹ | -M⁻¹t], a 3x3 inverse and a matrix-vector product. inverse4() picks
+* that path by itself; rigid_inverse4() goes further for an orthonormal M, whose
+* inverse is Mᵀ, and must be asked for explicitly since orthonormality is the
+* caller's guarantee.
+*
+* Kernels take row pointers so Matrix<K>, whose rows are separate vectors, and
+* plain buffers can share them. The output may alias the input.
+*/
+
+// |det| must exceed 1e-10 relative to the largest entry, to the power n
+template <typename K>
+bool nonsingular_det(K det, real_t<K> scale, int n)
+{
+    real_t<K> bound = real_t<K>(1e-10);
+    for (int i = 0; i < n; ++i)
+        bound *= scale;
+    return magnitude(det) > bound;
+}
+
+template <typename K>
+real_t<K> max_magnitude4(const K* const a[4], size_t rows, size_t cols)
+{
+    real_t<K> scale = 0;
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            scale = std::max(scale, magnitude(a[i][j]));
+    return scale;
+}
+
+// Last row (0 0 0 1)
+template <typename K>
+bool is_affine4(const K* const a[4])
+{
+    return a[3][0] == K(0) && a[3][1] == K(0) && a[3][2] == K(0) && a[3][3] == K(1);
+}
+
+// The 2x2 minors of rows 0-1 (s) and rows 2-3 (c); returns the determinant
+template <typename K>
+K minors4(const K* const a[4], K s[6], K c[6])
+{
+    s[0] = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    s[1] = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    s[2] = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    s[3] = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    s[4] = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    s[5] = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    c[0] = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+    c[1] = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    c[2] = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    c[3] = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    c[4] = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    c[5] = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+}
+
+#if defined(__SSE2__)
+// The six 2x2 minors of rows ra, rb as lo = (m0 m1 m2 m3) and hi = (m4 m5 m4 m5)
+inline void minors4(__m128 ra, __m128 rb, __m128& lo, __m128& hi)
+{
+    lo = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(ra, ra, _MM_SHUFFLE(1, 0, 0, 0)),
+                               _mm_shuffle_ps(rb, rb, _MM_SHUFFLE(2, 3, 2, 1))),
+                    _mm_mul_ps(_mm_shuffle_ps(rb, rb, _MM_SHUFFLE(1, 0, 0, 0)),
+                               _mm_shuffle_ps(ra, ra, _MM_SHUFFLE(2, 3, 2, 1))));
+    hi = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(ra, ra, _MM_SHUFFLE(2, 1, 2, 1)),
+                               _mm_shuffle_ps(rb, rb, _MM_SHUFFLE(3, 3, 3, 3))),
+                    _mm_mul_ps(_mm_shuffle_ps(rb, rb, _MM_SHUFFLE(2, 1, 2, 1)),
+                               _mm_shuffle_ps(ra, ra, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+
+// (r1·m5 - r2·m4 + r3·m3, r0·m5 - r2·m2 + r3·m1, r0·m4 - r1·m2 + r3·m0, r0·m3 - r1·m1 + r2·m0)
+inline __m128 cofactors4(__m128 r, __m128 lo, __m128 hi)
+{
+    __m128 t = _mm_shuffle_ps(hi, lo, _MM_SHUFFLE(3, 3, 0, 0));
+    __m128 p = _mm_shuffle_ps(hi, t, _MM_SHUFFLE(2, 0, 1, 1));      // m5 m5 m4 m3
+    t = _mm_shuffle_ps(hi, lo, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 q = _mm_shuffle_ps(t, lo, _MM_SHUFFLE(1, 2, 2, 0));      // m4 m2 m2 m1
+    __m128 s = _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(0, 0, 1, 3));     // m3 m1 m0 m0
+    __m128 v = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 1)), p);
+    v = _mm_sub_ps(v, _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 2, 2)), q));
+    return _mm_add_ps(v, _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 3, 3, 3)), s));
+}
+
+inline __m128 broadcast_sum4(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+#endif
+
+/**
+ * @brief Determinant of a 4x4 matrix from its 2x2 minors
+ * @param a The four rows
+ */
+template <typename K>
+K det4_kernel(const K* const a[4])
+{
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<K, float>) {
+        __m128 lo, hi;
+        minors4(_mm_loadu_ps(a[2]), _mm_loadu_ps(a[3]), lo, hi);
+        __m128 column = _mm_xor_ps(cofactors4(_mm_loadu_ps(a[1]), lo, hi),
+                                   _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
+        return _mm_cvtss_f32(broadcast_sum4(_mm_mul_ps(_mm_loadu_ps(a[0]), column)));
+    }
+#endif
+    K s[6], c[6];
+    return minors4(a, s, c);
+}
+
+/**
+ * @brief General 4x4 inverse as adjugate / determinant
+ * @param a The four input rows
+ * @param out The four output rows, may be the input rows
+ * @return false, leaving out untouched, if |det| is below 1e-10·max|aij|⁴
+ */
+template <typename K>
+bool general_inverse4(const K* const a[4], K* const out[4])
+{
+    real_t<K> scale = max_magnitude4(a, 4, 4);
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<K, float>) {
+        __m128 r0 = _mm_loadu_ps(a[0]), r1 = _mm_loadu_ps(a[1]);
+        __m128 r2 = _mm_loadu_ps(a[2]), r3 = _mm_loadu_ps(a[3]);
+        __m128 plus = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+        __m128 minus = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+        __m128 slo, shi, clo, chi;
+        minors4(r0, r1, slo, shi);
+        minors4(r2, r3, clo, chi);
+        // Columns of the adjugate
+        __m128 b0 = _mm_xor_ps(cofactors4(r1, clo, chi), plus);
+        __m128 b1 = _mm_xor_ps(cofactors4(r0, clo, chi), minus);
+        __m128 b2 = _mm_xor_ps(cofactors4(r3, slo, shi), plus);
+        __m128 b3 = _mm_xor_ps(cofactors4(r2, slo, shi), minus);
+        __m128 det = broadcast_sum4(_mm_mul_ps(r0, b0));
+        if (!nonsingular_det(_mm_cvtss_f32(det), scale, 4))
+            return false;
+        __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        b0 = _mm_mul_ps(b0, inv);
+        b1 = _mm_mul_ps(b1, inv);
+        b2 = _mm_mul_ps(b2, inv);
+        b3 = _mm_mul_ps(b3, inv);
+        _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+        _mm_storeu_ps(out[0], b0);
+        _mm_storeu_ps(out[1], b1);
+        _mm_storeu_ps(out[2], b2);
+        _mm_storeu_ps(out[3], b3);
+        return true;
+    }
+#endif
+    K s[6], c[6];
+    K det = minors4(a, s, c);
+    if (!nonsingular_det(det, scale, 4))
+        return false;
+    K inv = K(1) / det;
+    K b[4][4] = {
+        { a[1][1] * c[5] - a[1][2] * c[4] + a[1][3] * c[3], -a[0][1] * c[5] + a[0][2] * c[4] - a[0][3] * c[3],
+          a[3][1] * s[5] - a[3][2] * s[4] + a[3][3] * s[3], -a[2][1] * s[5] + a[2][2] * s[4] - a[2][3] * s[3] },
+        { -a[1][0] * c[5] + a[1][2] * c[2] - a[1][3] * c[1], a[0][0] * c[5] - a[0][2] * c[2] + a[0][3] * c[1],
+          -a[3][0] * s[5] + a[3][2] * s[2] - a[3][3] * s[1], a[2][0] * s[5] - a[2][2] * s[2] + a[2][3] * s[1] },
+        { a[1][0] * c[4] - a[1][1] * c[2] + a[1][3] * c[0], -a[0][0] * c[4] + a[0][1] * c[2] - a[0][3] * c[0],
+          a[3][0] * s[4] - a[3][1] * s[2] + a[3][3] * s[0], -a[2][0] * s[4] + a[2][1] * s[2] - a[2][3] * s[0] },
+        { -a[1][0] * c[3] + a[1][1] * c[1] - a[1][2] * c[0], a[0][0] * c[3] - a[0][1] * c[1] + a[0][2] * c[0],
+          -a[3][0] * s[3] + a[3][1] * s[1] - a[3][2] * s[0], a[2][0] * s[3] - a[2][1] * s[1] + a[2][2] * s[0] },
+    };
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            out[i][j] = b[i][j] * inv;
+    return true;
+}
+
+/**
+ * @brief Inverse of an affine transform [M | t; 0 0 0 1] as [M⁻¹ | -M⁻¹t; 0 0 0 1]
+ *
+ * The last row of a is not read.
+ *
+ * @return false, leaving out untouched, if |det M| is below 1e-10·max|mij|³
+ */
+template <typename K>
+bool affine_inverse4(const K* const a[4], K* const out[4])
+{
+    K m[3][3] = {
+        { a[1][1] * a[2][2] - a[2][1] * a[1][2], a[0][2] * a[2][1] - a[0][1] * a[2][2],
+          a[0][1] * a[1][2] - a[1][1] * a[0][2] },
+        { a[1][2] * a[2][0] - a[1][0] * a[2][2], a[0][0] * a[2][2] - a[0][2] * a[2][0],
+          a[0][2] * a[1][0] - a[0][0] * a[1][2] },
+        { a[1][0] * a[2][1] - a[1][1] * a[2][0], a[0][1] * a[2][0] - a[0][0] * a[2][1],
+          a[0][0] * a[1][1] - a[0][1] * a[1][0] },
+    };
+    K det = a[0][0] * m[0][0] + a[0][1] * m[1][0] + a[0][2] * m[2][0];
+    if (!nonsingular_det(det, max_magnitude4(a, 3, 3), 3))
+        return false;
+    K inv = K(1) / det;
+    K t[3] = { a[0][3], a[1][3], a[2][3] };
+    for (size_t i = 0; i < 3; ++i) {
+        K* r = out[i];
+        r[0] = m[i][0] * inv;
+        r[1] = m[i][1] * inv;
+        r[2] = m[i][2] * inv;
+        r[3] = -(r[0] * t[0] + r[1] * t[1] + r[2] * t[2]);
+    }
+    out[3][0] = out[3][1] = out[3][2] = K(0);
+    out[3][3] = K(1);
+    return true;
+}
+
+/**
+ * @brief Inverse of a rigid transform [R | t; 0 0 0 1] as [Rᵀ | -Rᵀt; 0 0 0 1]
+ *
+ * R is assumed orthonormal and is not checked. For complex K, Rᵀ is the
+ * conjugate transpose. The last row of a is not read.
+ */
+template <typename K>
+void rigid_inverse4(const K* const a[4], K* const out[4])
+{
+    K r[3][3];
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            r[i][j] = conjugate(a[j][i]);
+    K t[3] = { a[0][3], a[1][3], a[2][3] };
+    for (size_t i = 0; i < 3; ++i) {
+        out[i][0] = r[i][0];
+        out[i][1] = r[i][1];
+        out[i][2] = r[i][2];
+        out[i][3] = -(r[i][0] * t[0] + r[i][1] * t[1] + r[i][2] * t[2]);
+    }
+    out[3][0] = out[3][1] = out[3][2] = K(0);
+    out[3][3] = K(1);
+}
+
+/**
+ * @brief 4x4 inverse, through affine_inverse4() when the last row is (0 0 0 1)
+ * @return false if the matrix is singular
+ */
+template <typename K>
+bool inverse4(const K* const a[4], K* const out[4])
+{
+    return is_affine4(a) ? affine_inverse4(a, out) : general_inverse4(a, out);
+}
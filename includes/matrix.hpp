@@ -1,5 +1,7 @@
 #pragma once
 
+#include "complex.hpp"
+#include "mat4.hpp"
 #include <cstddef>
 #include <iostream>
 #include <vector>
@@ -19,6 +21,26 @@ class Matrix {
         Matrix() : _data() {}
 
         Matrix(const Matrix<K>& other) : _data(other._data) {}
+
+        Matrix<K>& operator=(const Matrix<K>& other)
+        {
+            this->_data = other._data;
+            return *this;
+        }
+
+        // Exchanges the contents of two matrices in O(1), without copying the rows
+        void swap(Matrix<K>& other)
+        {
+            this->_data.swap(other._data);
+        }
+
+        // Reshapes to rows x cols keeping the allocated row buffers; element values are unspecified
+        void resize(size_t rows, size_t cols)
+        {
+            this->_data.resize(rows);
+            for (std::vector<K>& row : this->_data)
+                row.resize(cols);
+        }
         
         explicit Matrix(std::vector<std::vector<K>> data)
         {
@@ -286,6 +308,13 @@ class Matrix {
             if (this->getCols() != A.getRows())
                 throw std::invalid_argument("The matrix sizes don't match.");
 
+            if constexpr (ScalarTraits<K>::is_complex) {
+                Matrix<K> result(std::vector<std::vector<K>>(this->getRows(), std::vector<K>(A.getCols())));
+                complex_mul_mat(*this, A, result);
+                _data = result._data;
+                return;
+            }
+
             std::vector<std::vector<K>> result;
 
             for (size_t i = 0; i < this->getRows(); i++) {
@@ -355,6 +384,21 @@ class Matrix {
             this->_data = transposed_data;
         }
 
+        /**
+        * @brief Replaces the matrix by its conjugate (Hermitian) transpose A*
+        * 
+        * Same as transpose() for real element types.
+        */
+        void conj_transpose()
+        {
+            this->transpose();
+            if constexpr (ScalarTraits<K>::is_complex) {
+                for (size_t i = 0; i < this->getRows(); i++)
+                    for (size_t j = 0; j < this->getCols(); j++)
+                        this->_data[i][j] = conjugate(this->_data[i][j]);
+            }
+        }
+
         /*========================= EX 10 =========================*/
         /*
         * Methods for the vector class based on the ex06 instructions.
@@ -401,7 +445,7 @@ class Matrix {
                     
                 // Find the first row with non-zero entry in pivot column
                 size_t pr = i; // pivot row
-                while (pr < rows && std::abs(result[pr][pc]) < K(1e-10))
+                while (pr < rows && magnitude(result[pr][pc]) < real_t<K>(1e-10))
                     ++pr;
                     
                 // If no pivot found, move to next column
@@ -410,18 +454,13 @@ class Matrix {
                     continue;
                 }
                 
-                // Swap rows if necessary
-                if (pr != i) {
-                    for (size_t j = 0; j < cols; ++j) {
-                        K tmp = result[i][j];
-                        result[i][j] = result[pr][j];
-                        result[pr][j] = tmp;
-                    }
-                }
+                // Swap rows if necessary (exchanges the row buffers, no element copy)
+                if (pr != i)
+                    std::swap(result._data[i], result._data[pr]);
                 
                 // Scale the pivot row to make pivot = 1
                 K pv = result[i][pc];
-                if (std::abs(pv) > K(1e-10)) {
+                if (magnitude(pv) > real_t<K>(1e-10)) {
                     for (size_t j = 0; j < cols; ++j)
                         result[i][j] /= pv;
                 }
@@ -488,6 +527,8 @@ class Matrix {
         * @throws std::runtime_error If the matrix is singular and cannot be inverted
         * 
         * @note The method uses a tolerance of 1e-10 to determine if the matrix is singular
+        * @note 4x4 matrices go through the closed-form inverse4() of mat4.hpp instead,
+        *       where the tolerance is relative: |det| < 1e-10·max|aij|⁴
         * @time_complexity O(n³) where n is the dimension of the square matrix
         * @space_complexity O(n²) for the working matrices
         */
@@ -497,6 +538,13 @@ class Matrix {
                 throw std::invalid_argument("Matrix must be square");
 
             size_t n = this->getRows();
+            if (n == 4) {
+                const K* a[4] = {_data[0].data(), _data[1].data(), _data[2].data(), _data[3].data()};
+                K* out[4] = {_data[0].data(), _data[1].data(), _data[2].data(), _data[3].data()};
+                if (!inverse4(a, out))
+                    throw std::runtime_error("Matrix is singular and cannot be inverted");
+                return;
+            }
             
             Matrix<K> mat(*this);
             Matrix<K> result(*this);
@@ -509,16 +557,15 @@ class Matrix {
             for (size_t i = 0; i < n; ++i) {
                 size_t max_row = i;
                 for (size_t row = i + 1; row < n; ++row) {
-                    if (std::abs(mat[i][row]) > std::abs(mat[i][max_row])) {
+                    if (std::abs(mat[row][i]) > std::abs(mat[max_row][i])) {
                         max_row = row;
                     }
                 }
                 
+                // Row exchanges swap the row buffers instead of copying elements
                 if (max_row != i) {
-                    for (size_t col = 0; col < n; ++col) {
-                        std::swap(mat[col][i], mat[col][max_row]);
-                        std::swap(result[col][i], result[col][max_row]);
-                    }
+                    std::swap(mat._data[i], mat._data[max_row]);
+                    std::swap(result._data[i], result._data[max_row]);
                 }
                 
                 if (std::abs(mat[i][i]) < 1e-10) {
@@ -527,16 +574,16 @@ class Matrix {
                 
                 K pivot = mat[i][i];
                 for (size_t col = 0; col < n; ++col) {
-                    mat[col][i] /= pivot;
-                    result[col][i] /= pivot;
+                    mat[i][col] /= pivot;
+                    result[i][col] /= pivot;
                 }
                 
                 for (size_t row = 0; row < n; ++row) {
                     if (row != i) {
-                        K factor = mat[i][row];
+                        K factor = mat[row][i];
                         for (size_t col = 0; col < n; ++col) {
-                            mat[col][row] -= factor * mat[col][i];
-                            result[col][row] -= factor * result[col][i];
+                            mat[row][col] -= factor * mat[i][col];
+                            result[row][col] -= factor * result[i][col];
                         }
                     }
                 }
@@ -564,18 +611,18 @@ class Matrix {
         */
         K rank()
         {
-            K rank = 0; 
+            size_t rank = 0; 
             Matrix<K> tmp(*this);
             tmp.row_echelon();
             for (size_t col = 0; col < tmp.getCols(); ++col)
             {
                 for (size_t row = 0; row < tmp.getRows(); ++row)
                 {
-                    if (col == row && std::abs(tmp[col][row]) > K(0e5))
+                    if (col == row && magnitude(tmp[col][row]) > real_t<K>(0e5))
                         rank++;
                 }
             }
-            return rank;
+            return K(rank);
         }
     };
 
@@ -744,6 +791,43 @@ Vector<K> mul_vec(const Matrix<K>& M, const Vector<K>& u)
     return result;
 }
 
+/**
+* @brief Computes out = M·u into an existing vector.
+* 
+* Same product as mul_vec(M, u) but the result is written into `out`, which is
+* only resized when its size differs from the row count. Called in a loop with
+* the same output buffer it does not allocate, which is what the iterative
+* solvers rely on: any operator type providing this overload can be solved.
+* 
+* @tparam K The data type of the vector and matrix elements.
+* @param M The matrix representing the linear transformation.
+* @param u The vector to be transformed.
+* @param out The vector receiving the result (must not alias u).
+* 
+* @throws std::invalid_argument If the size of the vector does not match the 
+*         number of columns in the matrix.
+*/
+template <typename K>
+void mul_vec(const Matrix<K>& M, const Vector<K>& u, Vector<K>& out)
+{
+    if (u.getSize() != M.getCols())
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+
+    size_t rows = M.getRows();
+    size_t cols = M.getCols();
+    if (out.getSize() != rows)
+        out.resize(rows);
+    const K* x = u.data();
+    K* y = out.data();
+    for (size_t i = 0; i < rows; i++) {
+        const K* row = M[i].data();
+        K sum = 0;
+        for (size_t j = 0; j < cols; j++)
+            sum += row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
 
 /**
 * @brief Computes the matrix multiplication of two matrices.
@@ -763,6 +847,12 @@ Matrix<K> mul_mat(Matrix<K> A, Matrix<K> B) {
     if (A.getCols() != B.getRows())
         throw std::invalid_argument("The matrix sizes don't match.");
 
+    if constexpr (ScalarTraits<K>::is_complex) {
+        Matrix<K> result(std::vector<std::vector<K>>(A.getRows(), std::vector<K>(B.getCols())));
+        complex_mul_mat(A, B, result);
+        return result;
+    }
+
     Matrix<K> result;
 
     for (size_t i = 0; i < A.getRows(); i++) {
@@ -809,6 +899,43 @@ Matrix<K> transpose(const Matrix<K>& A)
     return Matrix<K>(transposed_data);
 }
 
+/**
+ * @brief Computes the conjugate (Hermitian) transpose A* of a matrix
+ * 
+ * Element (i,j) of the result is conj(A[j][i]). For real element types this
+ * is the same as transpose().
+ * 
+ * @tparam K Type of elements in the matrix
+ * @param A The input matrix
+ * @return Matrix<K> The conjugate transpose
+ */
+template <typename K>
+Matrix<K> conj_transpose(const Matrix<K>& A)
+{
+    Matrix<K> result(A);
+    result.conj_transpose();
+    return result;
+}
+
+/**
+ * @brief Complex matrix product C = A·B through the interleaved SIMD kernel
+ * 
+ * C must already be zeroed and sized A.getRows() x B.getCols().
+ */
+template <typename K>
+void complex_mul_mat(const Matrix<K>& A, const Matrix<K>& B, Matrix<K>& C)
+{
+    std::vector<const K*> a(A.getRows()), b(B.getRows());
+    std::vector<K*> c(C.getRows());
+    for (size_t i = 0; i < A.getRows(); ++i)
+        a[i] = A[i].data();
+    for (size_t i = 0; i < B.getRows(); ++i)
+        b[i] = B[i].data();
+    for (size_t i = 0; i < C.getRows(); ++i)
+        c[i] = C[i].data();
+    complex_gemm(a.data(), b.data(), c.data(), A.getRows(), A.getCols(), B.getCols());
+}
+
 
 /**
  * @brief Computes the inverse of a square matrix using Gaussian elimination with pivoting.
@@ -825,6 +952,8 @@ Matrix<K> transpose(const Matrix<K>& A)
  * @throws std::runtime_error If the matrix is singular and cannot be inverted
  * 
  * @note The function uses a tolerance of 1e-10 to determine if the matrix is singular
+ * @note 4x4 matrices go through the closed-form inverse4() of mat4.hpp instead,
+ *       where the tolerance is relative: |det| < 1e-10·max|aij|⁴
  * @time_complexity O(n³) where n is the dimension of the square matrix
  * @space_complexity O(n²) for the result and working matrices
  */
@@ -835,6 +964,14 @@ Matrix<K> inverse(const Matrix<K>& A)
         throw std::invalid_argument("Matrix must be square");
 
     size_t n = A.getRows();
+    if (n == 4) {
+        Matrix<K> result(A);
+        const K* a[4] = {A[0].data(), A[1].data(), A[2].data(), A[3].data()};
+        K* out[4] = {result[0].data(), result[1].data(), result[2].data(), result[3].data()};
+        if (!inverse4(a, out))
+            throw std::runtime_error("Matrix is singular and cannot be inverted");
+        return result;
+    }
     
     Matrix<K> mat(A);
     Matrix<K> result(A);
@@ -847,16 +984,15 @@ Matrix<K> inverse(const Matrix<K>& A)
     for (size_t i = 0; i < n; ++i) {
         size_t max_row = i;
         for (size_t row = i + 1; row < n; ++row) {
-            if (std::abs(mat[i][row]) > std::abs(mat[i][max_row])) {
+            if (std::abs(mat[row][i]) > std::abs(mat[max_row][i])) {
                 max_row = row;
             }
         }
         
+        // Row exchanges swap the row buffers instead of copying elements
         if (max_row != i) {
-            for (size_t col = 0; col < n; ++col) {
-                std::swap(mat[col][i], mat[col][max_row]);
-                std::swap(result[col][i], result[col][max_row]);
-            }
+            std::swap(mat[i], mat[max_row]);
+            std::swap(result[i], result[max_row]);
         }
         
         if (std::abs(mat[i][i]) < 1e-10) {
@@ -865,16 +1001,16 @@ Matrix<K> inverse(const Matrix<K>& A)
         
         K pivot = mat[i][i];
         for (size_t col = 0; col < n; ++col) {
-            mat[col][i] /= pivot;
-            result[col][i] /= pivot;
+            mat[i][col] /= pivot;
+            result[i][col] /= pivot;
         }
         
         for (size_t row = 0; row < n; ++row) {
             if (row != i) {
-                K factor = mat[i][row];
+                K factor = mat[row][i];
                 for (size_t col = 0; col < n; ++col) {
-                    mat[col][row] -= factor * mat[col][i];
-                    result[col][row] -= factor * result[col][i];
+                    mat[row][col] -= factor * mat[i][col];
+                    result[row][col] -= factor * result[i][col];
                 }
             }
         }
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "reduction.hpp"
+#include "vector.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/*
+* Reductions along one axis of a Matrix, without extracting rows or columns.
+*
+* Rows are contiguous, so the row_* functions reduce each row in place with
+* the multi-accumulator kernels of reduction.hpp, rows split over threads.
+* Walking down a column would touch one cache line per element, so the col_*
+* functions stream the matrix row by row instead and update one running
+* result per column: the inner loop is a contiguous element-wise update that
+* the compiler can vectorise. Threads each take a slice of columns, so every
+* output is written by a single thread and no merge is needed.
+*/
+
+enum class NormKind {
+    L1,
+    L2,
+    Inf
+};
+
+const size_t AXIS_GRAIN = 64;
+
+// Number of columns, 0 for an empty matrix (getCols() reads row 0)
+template <typename K>
+size_t axis_cols(const Matrix<K>& A)
+{
+    return A.getRows() ? A.getCols() : 0;
+}
+
+// result[i] = fn(row i, row size) for every row, rows split over threads
+template <typename R, typename K, typename F>
+Vector<R> reduce_rows(const Matrix<K>& A, F fn, size_t threads)
+{
+    Vector<R> out{std::vector<R>(A.getRows())};
+    R* o = out.data();
+    parallel_for(0, A.getRows(), AXIS_GRAIN, [&A, &fn, o](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i)
+            o[i] = fn(A[i].data(), A[i].size());
+    }, threads);
+    return out;
+}
+
+// Streams the rows into acc[j] with update(acc, row, lo, hi), column slices split over threads
+template <typename R, typename K, typename F>
+void reduce_cols(const Matrix<K>& A, R* acc, F update, size_t threads)
+{
+    parallel_for(0, axis_cols(A), AXIS_GRAIN, [&A, acc, &update](size_t lo, size_t hi) {
+        for (size_t i = 0; i < A.getRows(); ++i)
+            update(acc, A[i].data(), lo, hi);
+    }, threads);
+}
+
+/**
+ * @brief Sum of every row: result[i] = Σⱼ A[i][j]
+ *
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ */
+template <typename K>
+Vector<K> row_sums(const Matrix<K>& A, size_t threads = 0)
+{
+    return reduce_rows<K>(A, [](const K* r, size_t n) {
+        return reduce_sum<K>(n, [r](size_t j) { return r[j]; });
+    }, threads);
+}
+
+/**
+ * @brief Sum of every column: result[j] = Σᵢ A[i][j]
+ *
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ */
+template <typename K>
+Vector<K> col_sums(const Matrix<K>& A, size_t threads = 0)
+{
+    Vector<K> out{std::vector<K>(axis_cols(A))};
+    reduce_cols(A, out.data(), [](K* acc, const K* r, size_t lo, size_t hi) {
+        for (size_t j = lo; j < hi; ++j)
+            acc[j] += r[j];
+    }, threads);
+    return out;
+}
+
+/**
+ * @brief Norm of every row, as norm_1(), norm() or norm_inf() would compute it
+ *
+ * @param kind L1, L2 (default) or Inf
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @return Vector<real_t<K>> One norm per row
+ */
+template <typename K>
+Vector<real_t<K>> row_norms(const Matrix<K>& A, NormKind kind = NormKind::L2, size_t threads = 0)
+{
+    using R = real_t<K>;
+    return reduce_rows<R>(A, [kind](const K* r, size_t n) {
+        if (kind == NormKind::Inf)
+            return n ? reduce_max<R>(n, [r](size_t j) { return magnitude(r[j]); }) : R(0);
+        if (kind == NormKind::L1)
+            return reduce_sum<R>(n, [r](size_t j) { return magnitude(r[j]); });
+        return std::sqrt(reduce_sum<R>(n, [r](size_t j) {
+            return ScalarTraits<K>::real(conjugate(r[j]) * r[j]);
+        }));
+    }, threads);
+}
+
+/**
+ * @brief Norm of every column
+ *
+ * @param kind L1, L2 (default) or Inf
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @return Vector<real_t<K>> One norm per column
+ */
+template <typename K>
+Vector<real_t<K>> col_norms(const Matrix<K>& A, NormKind kind = NormKind::L2, size_t threads = 0)
+{
+    using R = real_t<K>;
+    Vector<R> out{std::vector<R>(axis_cols(A))};
+    if (kind == NormKind::Inf) {
+        reduce_cols(A, out.data(), [](R* acc, const K* r, size_t lo, size_t hi) {
+            for (size_t j = lo; j < hi; ++j) {
+                R m = magnitude(r[j]);
+                acc[j] = m > acc[j] ? m : acc[j];
+            }
+        }, threads);
+    } else if (kind == NormKind::L1) {
+        reduce_cols(A, out.data(), [](R* acc, const K* r, size_t lo, size_t hi) {
+            for (size_t j = lo; j < hi; ++j)
+                acc[j] += magnitude(r[j]);
+        }, threads);
+    } else {
+        reduce_cols(A, out.data(), [](R* acc, const K* r, size_t lo, size_t hi) {
+            for (size_t j = lo; j < hi; ++j)
+                acc[j] += ScalarTraits<K>::real(conjugate(r[j]) * r[j]);
+        }, threads);
+        R* o = out.data();
+        for (size_t j = 0; j < out.getSize(); ++j)
+            o[j] = std::sqrt(o[j]);
+    }
+    return out;
+}
+
+/**
+ * @brief Index of the largest element of every row (first one on ties)
+ *
+ * @throws std::runtime_error If the matrix has no columns
+ */
+template <typename K>
+Vector<size_t> row_argmax(const Matrix<K>& A, size_t threads = 0)
+{
+    if (A.getRows() && A.getCols() == 0)
+        throw std::runtime_error("Cannot find maximum of an empty vector");
+    return reduce_rows<size_t>(A, [](const K* r, size_t n) {
+        size_t best = 0;
+        for (size_t j = 1; j < n; ++j)
+            if (r[j] > r[best])
+                best = j;
+        return best;
+    }, threads);
+}
+
+/**
+ * @brief Largest element of every row, like Vector::max()
+ *
+ * @throws std::runtime_error If the matrix has no columns
+ */
+template <typename K>
+Vector<K> row_max(const Matrix<K>& A, size_t threads = 0)
+{
+    if (A.getRows() && A.getCols() == 0)
+        throw std::runtime_error("Cannot find maximum of an empty vector");
+    return reduce_rows<K>(A, [](const K* r, size_t n) {
+        return reduce_max<K>(n, [r](size_t j) { return r[j]; });
+    }, threads);
+}
+
+/**
+ * @brief Row index of the largest element of every column (first one on ties)
+ *
+ * Running maxima are kept for a slice of columns while the rows stream by,
+ * so col_max() comes for free: pass a vector to receive it.
+ *
+ * @param max If not null, receives the column maxima
+ * @throws std::runtime_error If the matrix has no rows
+ */
+template <typename K>
+Vector<size_t> col_argmax(const Matrix<K>& A, Vector<K>* max = nullptr, size_t threads = 0)
+{
+    if (A.getRows() == 0)
+        throw std::runtime_error("Cannot find maximum of an empty vector");
+    size_t cols = A.getCols();
+    Vector<size_t> index{std::vector<size_t>(cols)};
+    Vector<K> best{A[0]};
+    size_t* idx = index.data();
+    K* b = best.data();
+    parallel_for(0, cols, AXIS_GRAIN, [&A, idx, b](size_t lo, size_t hi) {
+        for (size_t i = 1; i < A.getRows(); ++i) {
+            const K* r = A[i].data();
+            for (size_t j = lo; j < hi; ++j) {
+                bool greater = r[j] > b[j];
+                b[j] = greater ? r[j] : b[j];
+                idx[j] = greater ? i : idx[j];
+            }
+        }
+    }, threads);
+    if (max)
+        *max = best;
+    return index;
+}
+
+/**
+ * @brief Largest element of every column
+ *
+ * @throws std::runtime_error If the matrix has no rows
+ */
+template <typename K>
+Vector<K> col_max(const Matrix<K>& A, size_t threads = 0)
+{
+    Vector<K> max;
+    col_argmax(A, &max, threads);
+    return max;
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+* Batched 3D geometry on structure-of-arrays buffers.
+*
+* cross_product() works on one Vector at a time and allocates its result, so
+* computing the normals of a mesh costs a couple of heap allocations per
+* triangle. Here points are stored as three separate x, y and z arrays: the
+* same component of consecutive points is contiguous, so 4 (SSE) or 8 (AVX)
+* cross products are computed per instruction without any shuffle. Meshes are
+* indexed triangle lists as found in ex14/assets/model.obj.
+*/
+
+/**
+ * @brief Structure-of-arrays 3D points or vectors: point i is (x[i], y[i], z[i])
+ */
+template <typename K>
+struct Points3 {
+    std::vector<K> x;
+    std::vector<K> y;
+    std::vector<K> z;
+
+    size_t size() const { return x.size(); }
+
+    void resize(size_t n)
+    {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+
+    void push_back(K px, K py, K pz)
+    {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+    }
+};
+
+/**
+ * @brief Indexed triangle mesh: triangle t uses vertices indices[3t], [3t+1], [3t+2]
+ */
+template <typename K>
+struct Mesh {
+    Points3<K> vertices;
+    std::vector<uint32_t> indices;
+
+    size_t triangles() const { return indices.size() / 3; }
+};
+
+const size_t MESH_TILE = 256;
+
+/**
+ * @brief o[i] = a[i] × b[i] for n vectors stored as separate x, y, z arrays
+ *
+ * The outputs may alias the inputs element for element.
+ */
+template <typename K>
+void cross_batch(const K* ax, const K* ay, const K* az, const K* bx, const K* by, const K* bz,
+                 K* ox, K* oy, K* oz, size_t n)
+{
+    size_t i = 0;
+    if constexpr (std::is_same_v<K, float>) {
+#if defined(__AVX__)
+        for (; i + 8 <= n; i += 8) {
+            __m256 vax = _mm256_loadu_ps(ax + i), vay = _mm256_loadu_ps(ay + i), vaz = _mm256_loadu_ps(az + i);
+            __m256 vbx = _mm256_loadu_ps(bx + i), vby = _mm256_loadu_ps(by + i), vbz = _mm256_loadu_ps(bz + i);
+            _mm256_storeu_ps(ox + i, _mm256_sub_ps(_mm256_mul_ps(vay, vbz), _mm256_mul_ps(vaz, vby)));
+            _mm256_storeu_ps(oy + i, _mm256_sub_ps(_mm256_mul_ps(vaz, vbx), _mm256_mul_ps(vax, vbz)));
+            _mm256_storeu_ps(oz + i, _mm256_sub_ps(_mm256_mul_ps(vax, vby), _mm256_mul_ps(vay, vbx)));
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            __m128 vax = _mm_loadu_ps(ax + i), vay = _mm_loadu_ps(ay + i), vaz = _mm_loadu_ps(az + i);
+            __m128 vbx = _mm_loadu_ps(bx + i), vby = _mm_loadu_ps(by + i), vbz = _mm_loadu_ps(bz + i);
+            _mm_storeu_ps(ox + i, _mm_sub_ps(_mm_mul_ps(vay, vbz), _mm_mul_ps(vaz, vby)));
+            _mm_storeu_ps(oy + i, _mm_sub_ps(_mm_mul_ps(vaz, vbx), _mm_mul_ps(vax, vbz)));
+            _mm_storeu_ps(oz + i, _mm_sub_ps(_mm_mul_ps(vax, vby), _mm_mul_ps(vay, vbx)));
+        }
+#endif
+    }
+    for (; i < n; ++i) {
+        K cx = ay[i] * bz[i] - az[i] * by[i];
+        K cy = az[i] * bx[i] - ax[i] * bz[i];
+        K cz = ax[i] * by[i] - ay[i] * bx[i];
+        ox[i] = cx;
+        oy[i] = cy;
+        oz[i] = cz;
+    }
+}
+
+/**
+ * @brief Scales n vectors stored as x, y, z arrays to unit length in place
+ *
+ * Zero vectors stay zero.
+ */
+template <typename K>
+void normalize_batch(K* x, K* y, K* z, size_t n)
+{
+    size_t i = 0;
+    if constexpr (std::is_same_v<K, float>) {
+#if defined(__AVX__)
+        const __m256 one8 = _mm256_set1_ps(1.0f);
+        const __m256 zero8 = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+            __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)),
+                                        _mm256_mul_ps(vz, vz));
+            __m256 inv = _mm256_and_ps(_mm256_cmp_ps(len2, zero8, _CMP_GT_OQ),
+                                       _mm256_div_ps(one8, _mm256_sqrt_ps(len2)));
+            _mm256_storeu_ps(x + i, _mm256_mul_ps(vx, inv));
+            _mm256_storeu_ps(y + i, _mm256_mul_ps(vy, inv));
+            _mm256_storeu_ps(z + i, _mm256_mul_ps(vz, inv));
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4) {
+            __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+            __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+            __m128 inv = _mm_and_ps(_mm_cmpgt_ps(len2, zero), _mm_div_ps(one, _mm_sqrt_ps(len2)));
+            _mm_storeu_ps(x + i, _mm_mul_ps(vx, inv));
+            _mm_storeu_ps(y + i, _mm_mul_ps(vy, inv));
+            _mm_storeu_ps(z + i, _mm_mul_ps(vz, inv));
+        }
+#endif
+    }
+    for (; i < n; ++i) {
+        K len2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        if (len2 > K(0)) {
+            K inv = K(1) / std::sqrt(len2);
+            x[i] *= inv;
+            y[i] *= inv;
+            z[i] *= inv;
+        }
+    }
+}
+
+// Throws if the index list is not made of whole triangles of existing vertices
+template <typename K>
+void check_mesh(const Mesh<K>& mesh)
+{
+    if (mesh.indices.size() % 3 != 0)
+        throw std::invalid_argument("The index count must be a multiple of 3.");
+    for (uint32_t v : mesh.indices)
+        if (v >= mesh.vertices.size())
+            throw std::invalid_argument("Triangle index out of range.");
+}
+
+/**
+ * @brief Normal of every triangle, (b - a) × (c - a) for triangle (a, b, c)
+ *
+ * Triangles are processed in tiles of MESH_TILE: the two edges are gathered
+ * into SoA scratch buffers and crossed with cross_batch(). Without
+ * normalisation the length of each normal is twice the triangle area.
+ *
+ * @param mesh Source mesh
+ * @param normals Resized to one normal per triangle
+ * @param normalize Scale the normals to unit length (degenerate triangles give zero)
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If an index is out of range or the count is not a multiple of 3
+ */
+template <typename K>
+void face_normals(const Mesh<K>& mesh, Points3<K>& normals, bool normalize = true, size_t threads = 0)
+{
+    check_mesh(mesh);
+    size_t count = mesh.triangles();
+    normals.resize(count);
+    const Points3<K>& v = mesh.vertices;
+    const uint32_t* idx = mesh.indices.data();
+    parallel_for(0, count, MESH_TILE, [&](size_t lo, size_t hi) {
+        std::vector<K> edges(6 * MESH_TILE);
+        K* e1x = edges.data();
+        K* e1y = e1x + MESH_TILE;
+        K* e1z = e1y + MESH_TILE;
+        K* e2x = e1z + MESH_TILE;
+        K* e2y = e2x + MESH_TILE;
+        K* e2z = e2y + MESH_TILE;
+        for (size_t t = lo; t < hi; t += MESH_TILE) {
+            size_t n = std::min(MESH_TILE, hi - t);
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t a = idx[3 * (t + i)];
+                uint32_t b = idx[3 * (t + i) + 1];
+                uint32_t c = idx[3 * (t + i) + 2];
+                e1x[i] = v.x[b] - v.x[a];
+                e1y[i] = v.y[b] - v.y[a];
+                e1z[i] = v.z[b] - v.z[a];
+                e2x[i] = v.x[c] - v.x[a];
+                e2y[i] = v.y[c] - v.y[a];
+                e2z[i] = v.z[c] - v.z[a];
+            }
+            K* nx = normals.x.data() + t;
+            K* ny = normals.y.data() + t;
+            K* nz = normals.z.data() + t;
+            cross_batch(e1x, e1y, e1z, e2x, e2y, e2z, nx, ny, nz, n);
+            if (normalize)
+                normalize_batch(nx, ny, nz, n);
+        }
+    }, threads);
+}
+
+/**
+ * @brief Smooth normal of every vertex: the area-weighted sum of the normals of its triangles
+ *
+ * The unnormalised face normals are computed first. A vertex to triangle
+ * table (CSR) is then built once so each vertex gathers its own sum: the
+ * vertices are split over threads without any write conflict.
+ *
+ * @param mesh Source mesh
+ * @param normals Resized to one unit normal per vertex (zero for unused vertices)
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @throws std::invalid_argument If an index is out of range or the count is not a multiple of 3
+ */
+template <typename K>
+void vertex_normals(const Mesh<K>& mesh, Points3<K>& normals, size_t threads = 0)
+{
+    Points3<K> faces;
+    face_normals(mesh, faces, false, threads);
+
+    size_t vertices = mesh.vertices.size();
+    std::vector<size_t> start(vertices + 1, 0);
+    for (uint32_t v : mesh.indices)
+        ++start[v + 1];
+    for (size_t i = 0; i < vertices; ++i)
+        start[i + 1] += start[i];
+    std::vector<size_t> fill(start.begin(), start.end() - 1);
+    std::vector<size_t> adjacent(mesh.indices.size());
+    for (size_t k = 0; k < mesh.indices.size(); ++k)
+        adjacent[fill[mesh.indices[k]]++] = k / 3;
+
+    normals.resize(vertices);
+    parallel_for(0, vertices, MESH_TILE, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            K sx = K(0);
+            K sy = K(0);
+            K sz = K(0);
+            for (size_t k = start[i]; k < start[i + 1]; ++k) {
+                sx += faces.x[adjacent[k]];
+                sy += faces.y[adjacent[k]];
+                sz += faces.z[adjacent[k]];
+            }
+            normals.x[i] = sx;
+            normals.y[i] = sy;
+            normals.z[i] = sz;
+        }
+        normalize_batch(normals.x.data() + lo, normals.y.data() + lo, normals.z.data() + lo, hi - lo);
+    }, threads);
+}
+
+/**
+ * @brief Reads the vertices and faces of a Wavefront OBJ file
+ *
+ * Only `v` and `f` records are used. Face entries may be written v, v/t,
+ * v//n or v/t/n, with 1-based or negative (relative) indices. Polygons with
+ * more than 3 vertices are split into a triangle fan.
+ *
+ * @throws std::runtime_error If the file can't be opened or a face is invalid
+ */
+inline Mesh<float> load_obj(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error("Cannot open " + path);
+
+    Mesh<float> mesh;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        std::string tag;
+        in >> tag;
+        if (tag == "v") {
+            float x = 0;
+            float y = 0;
+            float z = 0;
+            in >> x >> y >> z;
+            mesh.vertices.push_back(x, y, z);
+        } else if (tag == "f") {
+            std::vector<uint32_t> face;
+            std::string entry;
+            while (in >> entry) {
+                long index = std::strtol(entry.c_str(), nullptr, 10);
+                if (index < 0)
+                    index += long(mesh.vertices.size()) + 1;
+                if (index < 1 || size_t(index) > mesh.vertices.size())
+                    throw std::runtime_error("Invalid face index in " + path);
+                face.push_back(uint32_t(index - 1));
+            }
+            if (face.size() < 3)
+                throw std::runtime_error("Face with less than 3 vertices in " + path);
+            for (size_t k = 1; k + 1 < face.size(); ++k) {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[k]);
+                mesh.indices.push_back(face[k + 1]);
+            }
+        }
+    }
+    return mesh;
+}
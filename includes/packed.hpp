@@ -0,0 +1,358 @@
+#pragma once
+
+#include "blas.hpp"
+#include "complex.hpp"
+#include "matrix.hpp"
+#include "reduction.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/*
+* Packed symmetric and triangular matrices.
+*
+* Only one triangle is stored, n·(n+1)/2 elements, row by row: row i of an
+* upper triangle holds columns i..n-1, row i of a lower triangle columns 0..i.
+* Rows stay contiguous like the rows of a Matrix, so the kernels below are the
+* row loops of their dense counterparts in blas.hpp, reading every stored
+* element exactly once:
+*  - a symmetric mat-vec uses each off-diagonal a(i, j) twice in the same
+*    pass, for y[i] += a·x[j] and y[j] += conj(a)·x[i];
+*  - a triangular solve or mat-vec is a dot (or an AXPY when transposed)
+*    per stored row.
+* Complex symmetric matrices are taken as Hermitian, like gram() produces.
+*/
+
+// Index of element (i, j) of row-wise packed triangle storage, (i, j) inside the triangle
+inline size_t packed_index(Triangle uplo, size_t n, size_t i, size_t j)
+{
+    if (uplo == Triangle::Upper)
+        return i * n - i * (i - 1) / 2 + (j - i);
+    return i * (i + 1) / 2 + j;
+}
+
+// Storage shared by the packed types: n, the triangle and the packed elements
+template <typename K>
+class PackedTriangle {
+
+    protected:
+        size_t _n;
+        Triangle _uplo;
+        std::vector<K> _data;
+
+        PackedTriangle(size_t n, Triangle uplo) : _n(n), _uplo(uplo), _data(n * (n + 1) / 2) {}
+
+    public:
+        size_t size() const { return _n; }
+        Triangle uplo() const { return _uplo; }
+        const std::vector<K>& packed() const { return _data; }
+
+        bool stored(size_t i, size_t j) const
+        {
+            return i < _n && j < _n && (_uplo == Triangle::Upper ? j >= i : j <= i);
+        }
+
+        // Stored part of row i: columns [first, last), the first one at row(i)[0]
+        void span(size_t i, size_t& first, size_t& last) const
+        {
+            triangle_span(_uplo, i, _n, first, last);
+        }
+        K* row(size_t i)
+        {
+            return _data.data() + packed_index(_uplo, _n, i, _uplo == Triangle::Upper ? i : 0);
+        }
+        const K* row(size_t i) const
+        {
+            return _data.data() + packed_index(_uplo, _n, i, _uplo == Triangle::Upper ? i : 0);
+        }
+
+        /**
+         * @brief Writable stored element (i, j)
+         * @throws std::out_of_range If (i, j) is not in the stored triangle
+         */
+        K& at(size_t i, size_t j)
+        {
+            if (!stored(i, j))
+                throw std::out_of_range("Element outside of the stored triangle");
+            return _data[packed_index(_uplo, _n, i, j)];
+        }
+};
+
+/**
+ * @brief Packed triangular matrix, zero outside of the stored triangle
+ */
+template <typename K>
+class PackedTriangular : public PackedTriangle<K> {
+
+    private:
+        Diag _diag;
+
+    public:
+        PackedTriangular(size_t n, Triangle uplo, Diag diag = Diag::NonUnit)
+            : PackedTriangle<K>(n, uplo), _diag(diag) {}
+
+        /**
+         * @brief Packs one triangle of a dense square matrix, the other one is ignored
+         * @throws std::invalid_argument If A is not square
+         */
+        static PackedTriangular from_dense(const Matrix<K>& A, Triangle uplo, Diag diag = Diag::NonUnit)
+        {
+            if (A.getRows() && A.getCols() != A.getRows())
+                throw std::invalid_argument("Matrix must be square");
+            PackedTriangular T(A.getRows(), uplo, diag);
+            for (size_t i = 0; i < T._n; ++i) {
+                size_t first, last;
+                T.span(i, first, last);
+                K* r = T.row(i);
+                for (size_t j = first; j < last; ++j)
+                    r[j - first] = A[i][j];
+            }
+            return T;
+        }
+
+        Diag diag() const { return _diag; }
+
+        /**
+         * @brief Element (i, j): zero outside of the triangle, one on a unit diagonal
+         */
+        K operator()(size_t i, size_t j) const
+        {
+            if (i == j && _diag == Diag::Unit)
+                return K(1);
+            return this->stored(i, j) ? this->_data[packed_index(this->_uplo, this->_n, i, j)] : K(0);
+        }
+
+        Matrix<K> to_dense() const
+        {
+            Matrix<K> A(std::vector<std::vector<K>>(this->_n, std::vector<K>(this->_n)));
+            for (size_t i = 0; i < this->_n; ++i)
+                for (size_t j = 0; j < this->_n; ++j)
+                    A[i][j] = (*this)(i, j);
+            return A;
+        }
+};
+
+/**
+ * @brief Packed symmetric (Hermitian for complex K) matrix
+ *
+ * Element (j, i) outside of the stored triangle reads as conj(a(i, j)).
+ */
+template <typename K>
+class PackedSymmetric : public PackedTriangle<K> {
+
+    public:
+        explicit PackedSymmetric(size_t n, Triangle uplo = Triangle::Upper) : PackedTriangle<K>(n, uplo) {}
+
+        /**
+         * @brief Packs one triangle of a dense square matrix, the other one is ignored
+         * @throws std::invalid_argument If A is not square
+         */
+        static PackedSymmetric from_dense(const Matrix<K>& A, Triangle uplo = Triangle::Upper)
+        {
+            if (A.getRows() && A.getCols() != A.getRows())
+                throw std::invalid_argument("Matrix must be square");
+            PackedSymmetric S(A.getRows(), uplo);
+            for (size_t i = 0; i < S._n; ++i) {
+                size_t first, last;
+                S.span(i, first, last);
+                K* r = S.row(i);
+                for (size_t j = first; j < last; ++j)
+                    r[j - first] = A[i][j];
+            }
+            return S;
+        }
+
+        K operator()(size_t i, size_t j) const
+        {
+            if (this->stored(i, j))
+                return this->_data[packed_index(this->_uplo, this->_n, i, j)];
+            return conjugate(this->_data[packed_index(this->_uplo, this->_n, j, i)]);
+        }
+
+        Matrix<K> to_dense() const
+        {
+            Matrix<K> A(std::vector<std::vector<K>>(this->_n, std::vector<K>(this->_n)));
+            for (size_t i = 0; i < this->_n; ++i)
+                for (size_t j = 0; j < this->_n; ++j)
+                    A[i][j] = (*this)(i, j);
+            return A;
+        }
+};
+
+/**
+ * @brief out = S·u reading each stored element once
+ *
+ * Does not allocate once `out` is sized, so a PackedSymmetric can be handed to
+ * the Krylov solvers.
+ *
+ * @throws std::invalid_argument If u does not have n elements
+ */
+template <typename K>
+void mul_vec(const PackedSymmetric<K>& S, const Vector<K>& u, Vector<K>& out)
+{
+    size_t n = S.size();
+    if (u.getSize() != n)
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    if (out.getSize() != n)
+        out.resize(n);
+    const K* x = u.data();
+    K* y = out.data();
+    std::fill(y, y + n, K(0));
+    for (size_t i = 0; i < n; ++i) {
+        size_t first, last;
+        S.span(i, first, last);
+        const K* r = S.row(i) - first;
+        K xi = x[i];
+        K sum = K(0);
+        // Off-diagonal part of the row, the diagonal is at its start (upper) or end (lower)
+        size_t lo = S.uplo() == Triangle::Upper ? i + 1 : first;
+        size_t hi = S.uplo() == Triangle::Upper ? last : i;
+        for (size_t j = lo; j < hi; ++j) {
+            sum += r[j] * x[j];
+            y[j] += conjugate(r[j]) * xi;
+        }
+        y[i] += sum + r[i] * xi;
+    }
+}
+
+template <typename K>
+Vector<K> mul_vec(const PackedSymmetric<K>& S, const Vector<K>& u)
+{
+    Vector<K> out;
+    mul_vec(S, u, out);
+    return out;
+}
+
+/**
+ * @brief out = T·u, one dot per stored row
+ *
+ * @throws std::invalid_argument If u does not have n elements
+ */
+template <typename K>
+void mul_vec(const PackedTriangular<K>& T, const Vector<K>& u, Vector<K>& out)
+{
+    size_t n = T.size();
+    if (u.getSize() != n)
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    if (out.getSize() != n)
+        out.resize(n);
+    const K* x = u.data();
+    K* y = out.data();
+    bool unit = T.diag() == Diag::Unit;
+    for (size_t i = 0; i < n; ++i) {
+        size_t first, last;
+        T.span(i, first, last);
+        // A unit diagonal is not read: leave it out of the dot
+        size_t lo = unit && T.uplo() == Triangle::Upper ? first + 1 : first;
+        size_t hi = unit && T.uplo() == Triangle::Lower ? last - 1 : last;
+        const K* r = T.row(i) - first;
+        y[i] = reduce_sum<K>(hi - lo, [r, x, lo](size_t j) { return r[lo + j] * x[lo + j]; });
+        if (unit)
+            y[i] += x[i];
+    }
+}
+
+template <typename K>
+Vector<K> mul_vec(const PackedTriangular<K>& T, const Vector<K>& u)
+{
+    Vector<K> out;
+    mul_vec(T, u, out);
+    return out;
+}
+
+/**
+ * @brief Solves op(T)·x = b in place (x holds b on entry), as trsv() on a Matrix
+ *
+ * @throws std::invalid_argument If x does not have n elements
+ * @throws std::runtime_error If a diagonal element is zero
+ */
+template <typename K>
+void trsv(const PackedTriangular<K>& T, Vector<K>& x, Op op = Op::NoTrans)
+{
+    size_t n = T.size();
+    if (x.getSize() != n)
+        throw std::invalid_argument("The matrix sizes don't match.");
+    K* px = x.data();
+    bool lower = op_lower(T.uplo(), op);
+    bool unit = T.diag() == Diag::Unit;
+    for (size_t s = 0; s < n; ++s) {
+        size_t i = lower ? s : n - 1 - s;
+        size_t first, last;
+        T.span(i, first, last);
+        const K* r = T.row(i) - first;
+        K d = unit ? K(1) : (op == Op::ConjTrans ? conjugate(r[i]) : r[i]);
+        if (d == K(0))
+            throw std::runtime_error("Triangular matrix is singular");
+        // Off-diagonal columns of the stored row i
+        size_t lo = T.uplo() == Triangle::Upper ? i + 1 : first;
+        size_t hi = T.uplo() == Triangle::Upper ? last : i;
+        if (op == Op::NoTrans) {
+            px[i] -= reduce_sum<K>(hi - lo, [r, px, lo](size_t j) { return r[lo + j] * px[lo + j]; });
+            px[i] /= d;
+        } else {
+            px[i] /= d;
+            if (op == Op::ConjTrans && ScalarTraits<K>::is_complex)
+                for (size_t j = lo; j < hi; ++j)
+                    px[j] -= px[i] * conjugate(r[j]);
+            else
+                row_axpy(px + lo, -px[i], r + lo, hi - lo);
+        }
+    }
+}
+
+/**
+ * @brief Packed Cholesky factorisation S = Uᴴ·U, U upper triangular
+ *
+ * Right-looking: once row k of U is known, the trailing triangle is updated
+ * row by row with an AXPY, all inside the packed storage.
+ *
+ * @throws std::runtime_error If S is not positive definite
+ * @time_complexity O(n³/3)
+ */
+template <typename K>
+PackedTriangular<K> cholesky(const PackedSymmetric<K>& S)
+{
+    using R = real_t<K>;
+    size_t n = S.size();
+    PackedTriangular<K> U(n, Triangle::Upper);
+    for (size_t i = 0; i < n; ++i) {
+        K* r = U.row(i) - i;
+        for (size_t j = i; j < n; ++j)
+            r[j] = S(i, j);
+    }
+    for (size_t k = 0; k < n; ++k) {
+        K* uk = U.row(k) - k;
+        R d = ScalarTraits<K>::real(uk[k]);
+        if (!(d > R(0)))
+            throw std::runtime_error("Matrix is not positive definite");
+        R pivot = std::sqrt(d);
+        uk[k] = K(pivot);
+        for (size_t j = k + 1; j < n; ++j)
+            uk[j] /= K(pivot);
+        for (size_t i = k + 1; i < n; ++i) {
+            K* ui = U.row(i) - i;
+            row_axpy(ui + i, -conjugate(uk[i]), uk + i, n - i);
+        }
+    }
+    return U;
+}
+
+/**
+ * @brief Solves S·x = b for a positive definite packed S through cholesky()
+ *
+ * @throws std::invalid_argument If b does not have n elements
+ * @throws std::runtime_error If S is not positive definite
+ */
+template <typename K>
+Vector<K> solve(const PackedSymmetric<K>& S, const Vector<K>& b)
+{
+    if (b.getSize() != S.size())
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    PackedTriangular<K> U = cholesky(S);
+    Vector<K> x(b);
+    trsv(U, x, Op::ConjTrans);
+    trsv(U, x, Op::NoTrans);
+    return x;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Number of threads used by the parallel kernels when none is requested
+ */
+inline size_t hardware_threads()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+/**
+ * @brief Runs fn(lo, hi) on contiguous chunks of [begin, end), one chunk per thread
+ * 
+ * Each thread gets at least `grain` items, so short ranges use fewer threads
+ * and a range shorter than two grains runs inline on the calling thread. The
+ * calling thread processes the last chunk itself. If a chunk throws, the first
+ * exception is rethrown once every thread has joined.
+ * 
+ * @param begin First index
+ * @param end One past the last index
+ * @param grain Minimum number of items worth a thread
+ * @param fn Callable taking (size_t lo, size_t hi)
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ */
+template <typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F fn, size_t threads = 0)
+{
+    if (end <= begin)
+        return;
+    size_t count = end - begin;
+    if (threads == 0)
+        threads = hardware_threads();
+    threads = std::min(threads, std::max<size_t>(1, count / std::max<size_t>(1, grain)));
+    if (threads <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(threads);
+    workers.reserve(threads - 1);
+    for (size_t t = 0; t + 1 < threads; ++t) {
+        size_t lo = begin + count * t / threads;
+        size_t hi = begin + count * (t + 1) / threads;
+        workers.emplace_back([&fn, &errors, t, lo, hi]() {
+            try {
+                fn(lo, hi);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    try {
+        fn(begin + count * (threads - 1) / threads, end);
+    } catch (...) {
+        errors[threads - 1] = std::current_exception();
+    }
+    for (std::thread& w : workers)
+        w.join();
+    for (std::exception_ptr& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+* 8-bit integer GEMV/GEMM with int32 accumulation.
+*
+* The generic templates accumulate in K (`K sum = 0`), which for int8_t wraps
+* after a couple of products. The overloads below take Matrix<int8_t> and
+* Vector<int8_t> and return int32 results, and the Quantized* types add one
+* f32 scale per row (symmetric quantisation, q = round(x / scale) in
+* [-127, 127]) so f32 data can be multiplied at a quarter of its size.
+*
+* Kernel selection, from fastest to slowest:
+*  - AVX-512 VNNI (vpdpbusd): 64 multiply-adds per instruction. It multiplies
+*    unsigned by signed bytes, so a is biased by +128 and 128·Σb is removed.
+*  - AVX2 vpmaddubsw: 32 multiply-adds per instruction, but it saturates its
+*    16-bit pair sums. With |a|, |b| <= 127 the pair sum stays below 32767, so
+*    it is only used for quantised data (`Symmetric` = true).
+*  - AVX2 vpmaddwd on sign-extended values: exact on the full int8 range,
+*    used for arbitrary Matrix<int8_t> input.
+*  - Portable scalar loop.
+*/
+
+/**
+ * @brief Σ a[i]·b[i] over int8 values, accumulated in int32
+ *
+ * @tparam Symmetric True when every value is in [-127, 127], which allows the
+ *         saturating vpmaddubsw path
+ */
+template <bool Symmetric>
+int32_t dot_i8(const int8_t* a, const int8_t* b, size_t n)
+{
+    size_t i = 0;
+    int32_t res = 0;
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    const __m512i bias = _mm512_set1_epi8(char(0x80));
+    const __m512i ones = _mm512_set1_epi8(1);
+    __m512i acc = _mm512_setzero_si512();
+    __m512i corr = _mm512_setzero_si512();
+    for (; i + 64 <= n; i += 64) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(va, bias), vb);   // (a + 128)·b
+        corr = _mm512_dpbusd_epi32(corr, ones, vb);                        // Σb
+    }
+    res += _mm512_reduce_add_epi32(_mm512_sub_epi32(acc, _mm512_slli_epi32(corr, 7)));
+#endif
+#if defined(__AVX2__)
+    __m256i acc2 = _mm256_setzero_si256();
+    if (Symmetric) {
+        const __m256i ones16 = _mm256_set1_epi16(1);
+        for (; i + 32 <= n; i += 32) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            // |a| as unsigned times b carrying the sign of a
+            __m256i pairs = _mm256_maddubs_epi16(_mm256_abs_epi8(va), _mm256_sign_epi8(vb, va));
+            acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(pairs, ones16));
+        }
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(va, vb));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc2), _mm256_extracti128_si256(acc2, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    res += _mm_cvtsi128_si32(s);
+#endif
+    for (; i < n; ++i)
+        res += int32_t(a[i]) * int32_t(b[i]);
+    return res;
+}
+
+/**
+ * @brief Matrix<int8_t>·Vector<int8_t> accumulated in int32 (exact)
+ * @throws std::invalid_argument If the vector size doesn't match the column count
+ */
+inline Vector<int32_t> mul_vec(const Matrix<int8_t>& M, const Vector<int8_t>& u)
+{
+    if (u.getSize() != M.getCols())
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    std::vector<int32_t> result(M.getRows());
+    for (size_t i = 0; i < M.getRows(); ++i)
+        result[i] = dot_i8<false>(M[i].data(), u.data(), M.getCols());
+    return Vector<int32_t>(result);
+}
+
+/**
+ * @brief Matrix<int8_t>·Matrix<int8_t> accumulated in int32 (exact)
+ *
+ * B is transposed once so each output element is a contiguous dot product.
+ * @throws std::invalid_argument If the matrix sizes don't match
+ */
+inline Matrix<int32_t> mul_mat(const Matrix<int8_t>& A, const Matrix<int8_t>& B)
+{
+    if (A.getCols() != B.getRows())
+        throw std::invalid_argument("The matrix sizes don't match.");
+    size_t n = A.getCols();
+    std::vector<std::vector<int8_t>> bt(B.getCols(), std::vector<int8_t>(n));
+    for (size_t k = 0; k < n; ++k)
+        for (size_t j = 0; j < B.getCols(); ++j)
+            bt[j][k] = B[k][j];
+    std::vector<std::vector<int32_t>> result(A.getRows(), std::vector<int32_t>(B.getCols()));
+    for (size_t i = 0; i < A.getRows(); ++i)
+        for (size_t j = 0; j < B.getCols(); ++j)
+            result[i][j] = dot_i8<false>(A[i].data(), bt[j].data(), n);
+    return Matrix<int32_t>(result);
+}
+
+
+/**
+ * @brief int8 matrix with one dequantisation scale per row: A[i][j] ≈ scales[i]·values[i][j]
+ */
+struct QuantizedMatrix {
+    Matrix<int8_t> values;
+    std::vector<f32> scales;
+};
+
+/**
+ * @brief int8 vector with a single dequantisation scale: v[i] ≈ scale·values[i]
+ */
+struct QuantizedVector {
+    Vector<int8_t> values;
+    f32 scale;
+};
+
+// Symmetric quantisation of n floats to [-127, 127], returns the scale
+inline f32 quantize_buffer(const f32* src, int8_t* dst, size_t n)
+{
+    f32 max_abs = 0;
+    for (size_t i = 0; i < n; ++i)
+        max_abs = std::fmax(max_abs, std::fabs(src[i]));
+    f32 scale = max_abs > 0 ? max_abs / 127.0f : 1.0f;
+    f32 inv = 1.0f / scale;
+    for (size_t i = 0; i < n; ++i) {
+        long q = std::lround(src[i] * inv);
+        dst[i] = int8_t(q > 127 ? 127 : (q < -127 ? -127 : q));
+    }
+    return scale;
+}
+
+/**
+ * @brief Quantises every row of A with its own scale
+ */
+inline QuantizedMatrix quantize_rows(const Matrix<f32>& A)
+{
+    std::vector<std::vector<int8_t>> values(A.getRows(), std::vector<int8_t>(A.getCols()));
+    QuantizedMatrix q;
+    q.scales.resize(A.getRows());
+    for (size_t i = 0; i < A.getRows(); ++i)
+        q.scales[i] = quantize_buffer(A[i].data(), values[i].data(), A.getCols());
+    q.values = Matrix<int8_t>(values);
+    return q;
+}
+
+/**
+ * @brief Quantises every column of B with its own scale, stored transposed
+ *
+ * The result holds Bᵀ (row j is column j of B) so it can be used as the right
+ * operand of mul_mat_transposed().
+ */
+inline QuantizedMatrix quantize_cols(const Matrix<f32>& B)
+{
+    return quantize_rows(transpose(B));
+}
+
+inline QuantizedVector quantize(const Vector<f32>& v)
+{
+    std::vector<int8_t> values(v.getSize());
+    QuantizedVector q;
+    q.scale = quantize_buffer(v.data(), values.data(), v.getSize());
+    q.values = Vector<int8_t>(values);
+    return q;
+}
+
+/**
+ * @brief Quantised GEMV: y[i] = scales[i]·x.scale·Σ values[i][j]·x.values[j]
+ * @throws std::invalid_argument If the vector size doesn't match the column count
+ */
+inline Vector<f32> mul_vec(const QuantizedMatrix& M, const QuantizedVector& x)
+{
+    if (x.values.getSize() != M.values.getCols())
+        throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+    std::vector<f32> result(M.values.getRows());
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = M.scales[i] * x.scale
+                    * f32(dot_i8<true>(M.values[i].data(), x.values.data(), x.values.getSize()));
+    return Vector<f32>(result);
+}
+
+/**
+ * @brief Quantised GEMM: A·B where A comes from quantize_rows() and Bt from quantize_cols(B)
+ * @throws std::invalid_argument If the inner dimensions don't match
+ */
+inline Matrix<f32> mul_mat_transposed(const QuantizedMatrix& A, const QuantizedMatrix& Bt)
+{
+    if (A.values.getCols() != Bt.values.getCols())
+        throw std::invalid_argument("The matrix sizes don't match.");
+    size_t n = A.values.getCols();
+    std::vector<std::vector<f32>> result(A.values.getRows(), std::vector<f32>(Bt.values.getRows()));
+    for (size_t i = 0; i < result.size(); ++i)
+        for (size_t j = 0; j < Bt.values.getRows(); ++j)
+            result[i][j] = A.scales[i] * Bt.scales[j]
+                           * f32(dot_i8<true>(A.values[i].data(), Bt.values[j].data(), n));
+    return Matrix<f32>(result);
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+#include "complex.hpp"
+#include "mat4.hpp"
+#include "matrix.hpp"
+#include "mesh.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/*
+* Rotations as unit quaternions.
+*
+* Composing two rotations stored as 4x4 matrices costs 64 multiplies, and the
+* rounding of every product slowly takes the 3x3 block away from orthonormal.
+* A quaternion composes in 16 multiplies and is brought back onto the unit
+* sphere by dividing by its norm. The four components are stored (x, y, z, w)
+* so a float quaternion is one SSE register: compose, normalize and the final
+* blend of slerp run on that register.
+*
+* Matrices are only built on request, through to_matrix3() and to_matrix4().
+* rotate_batch() turns the quaternion into its nine rotation coefficients once
+* and applies them to structure-of-arrays points (see mesh.hpp) 4 or 8 at a
+* time, without creating a Matrix.
+*/
+
+template <typename K>
+class Quaternion {
+
+    static_assert(!ScalarTraits<K>::is_complex, "Quaternion needs a real element type");
+
+    private:
+        K _q[4];    // x, y, z, w
+
+    public:
+        // The identity rotation
+        Quaternion() : _q{K(0), K(0), K(0), K(1)} {}
+        Quaternion(K w, K x, K y, K z) : _q{x, y, z, w} {}
+
+        /**
+         * @brief Rotation of `angle` radians about `axis`, right-handed
+         * @throws std::invalid_argument If axis is not a non-zero 3D vector
+         */
+        static Quaternion from_axis_angle(const Vector<K>& axis, K angle)
+        {
+            if (axis.getSize() != 3)
+                throw std::invalid_argument("The axis must be a non-zero 3D vector");
+            K length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            if (length == K(0))
+                throw std::invalid_argument("The axis must be a non-zero 3D vector");
+            K s = std::sin(angle / 2) / length;
+            return Quaternion(std::cos(angle / 2), axis[0] * s, axis[1] * s, axis[2] * s);
+        }
+
+        /**
+         * @brief Quaternion of a rotation matrix (Shepperd's method)
+         *
+         * Only the upper-left 3x3 block is read, which must be a rotation.
+         * A positive trace means w² > 1/4, so w is computed first and gives a
+         * well-scaled divisor. Otherwise the square root is taken for whichever
+         * of x, y, z has the largest diagonal entry. Rotations by π are then
+         * as accurate as the others.
+         *
+         * @throws std::invalid_argument If R is neither 3x3 nor 4x4
+         */
+        static Quaternion from_matrix(const Matrix<K>& R)
+        {
+            size_t n = R.getRows();
+            if ((n != 3 && n != 4) || R.getCols() != n)
+                throw std::invalid_argument("Rotation matrix must be 3x3 or 4x4");
+            K trace = R[0][0] + R[1][1] + R[2][2];
+            Quaternion q;
+            if (trace > K(0)) {
+                K s = std::sqrt(trace + K(1)) * 2;
+                q = Quaternion(s / 4, (R[2][1] - R[1][2]) / s, (R[0][2] - R[2][0]) / s, (R[1][0] - R[0][1]) / s);
+            } else if (R[0][0] > R[1][1] && R[0][0] > R[2][2]) {
+                K s = std::sqrt(K(1) + R[0][0] - R[1][1] - R[2][2]) * 2;
+                q = Quaternion((R[2][1] - R[1][2]) / s, s / 4, (R[0][1] + R[1][0]) / s, (R[0][2] + R[2][0]) / s);
+            } else if (R[1][1] > R[2][2]) {
+                K s = std::sqrt(K(1) + R[1][1] - R[0][0] - R[2][2]) * 2;
+                q = Quaternion((R[0][2] - R[2][0]) / s, (R[0][1] + R[1][0]) / s, s / 4, (R[1][2] + R[2][1]) / s);
+            } else {
+                K s = std::sqrt(K(1) + R[2][2] - R[0][0] - R[1][1]) * 2;
+                q = Quaternion((R[1][0] - R[0][1]) / s, (R[0][2] + R[2][0]) / s, (R[1][2] + R[2][1]) / s, s / 4);
+            }
+            q.normalize();
+            return q;
+        }
+
+        K w() const { return _q[3]; }
+        K x() const { return _q[0]; }
+        K y() const { return _q[1]; }
+        K z() const { return _q[2]; }
+
+        // x, y, z, w
+        const K* data() const { return _q; }
+        K* data() { return _q; }
+
+        K norm() const
+        {
+            return std::sqrt(_q[0] * _q[0] + _q[1] * _q[1] + _q[2] * _q[2] + _q[3] * _q[3]);
+        }
+
+        /**
+         * @brief Scales the quaternion back to unit length; a zero quaternion stays zero
+         */
+        void normalize()
+        {
+#if defined(__SSE2__)
+            if constexpr (std::is_same_v<K, float>) {
+                __m128 q = _mm_loadu_ps(_q);
+                __m128 len2 = broadcast_sum4(_mm_mul_ps(q, q));
+                __m128 inv = _mm_and_ps(_mm_cmpgt_ps(len2, _mm_setzero_ps()),
+                                        _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2)));
+                _mm_storeu_ps(_q, _mm_mul_ps(q, inv));
+                return;
+            }
+#endif
+            K length = norm();
+            if (length == K(0))
+                return;
+            for (K& c : _q)
+                c /= length;
+        }
+
+        Quaternion normalized() const
+        {
+            Quaternion q(*this);
+            q.normalize();
+            return q;
+        }
+
+        // The inverse rotation for a unit quaternion
+        Quaternion conjugate() const
+        {
+            return Quaternion(_q[3], -_q[0], -_q[1], -_q[2]);
+        }
+
+        /**
+         * @brief q⁻¹ = q* / |q|², also valid for non-unit quaternions
+         * @throws std::runtime_error If the quaternion is zero
+         */
+        Quaternion inverse() const
+        {
+            K len2 = _q[0] * _q[0] + _q[1] * _q[1] + _q[2] * _q[2] + _q[3] * _q[3];
+            if (len2 == K(0))
+                throw std::runtime_error("Quaternion is zero and cannot be inverted");
+            return Quaternion(_q[3] / len2, -_q[0] / len2, -_q[1] / len2, -_q[2] / len2);
+        }
+
+        /**
+         * @brief Row-major coefficients of the 3x3 rotation matrix
+         *
+         * Uses 2/|q|² rather than 2, so a quaternion that has drifted off the
+         * unit sphere still gives a rotation.
+         */
+        void coefficients(K m[9]) const
+        {
+            K x = _q[0], y = _q[1], z = _q[2], w = _q[3];
+            K len2 = x * x + y * y + z * z + w * w;
+            K s = len2 > K(0) ? K(2) / len2 : K(0);
+            K xx = x * x * s, yy = y * y * s, zz = z * z * s;
+            K xy = x * y * s, xz = x * z * s, yz = y * z * s;
+            K wx = w * x * s, wy = w * y * s, wz = w * z * s;
+            m[0] = K(1) - yy - zz;  m[1] = xy - wz;          m[2] = xz + wy;
+            m[3] = xy + wz;         m[4] = K(1) - xx - zz;  m[5] = yz - wx;
+            m[6] = xz - wy;         m[7] = yz + wx;          m[8] = K(1) - xx - yy;
+        }
+
+        Matrix<K> to_matrix3() const
+        {
+            K m[9];
+            coefficients(m);
+            return Matrix<K>({{m[0], m[1], m[2]}, {m[3], m[4], m[5]}, {m[6], m[7], m[8]}});
+        }
+
+        // Homogeneous rotation, no translation
+        Matrix<K> to_matrix4() const
+        {
+            K m[9];
+            coefficients(m);
+            return Matrix<K>({{m[0], m[1], m[2], K(0)}, {m[3], m[4], m[5], K(0)},
+                              {m[6], m[7], m[8], K(0)}, {K(0), K(0), K(0), K(1)}});
+        }
+
+        /**
+         * @brief Rotates one 3D vector
+         * @throws std::invalid_argument If v is not 3D
+         */
+        Vector<K> rotate(const Vector<K>& v) const
+        {
+            if (v.getSize() != 3)
+                throw std::invalid_argument("The vector size doesn't match the matrix column count.");
+            K m[9];
+            coefficients(m);
+            return Vector<K>({m[0] * v[0] + m[1] * v[1] + m[2] * v[2],
+                              m[3] * v[0] + m[4] * v[1] + m[5] * v[2],
+                              m[6] * v[0] + m[7] * v[1] + m[8] * v[2]});
+        }
+};
+
+template <typename K>
+K dot(const Quaternion<K>& p, const Quaternion<K>& q)
+{
+    const K* a = p.data();
+    const K* b = q.data();
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+}
+
+/**
+ * @brief Hamilton product: the rotation q followed by the rotation p
+ */
+template <typename K>
+Quaternion<K> operator*(const Quaternion<K>& p, const Quaternion<K>& q)
+{
+    Quaternion<K> r;
+    const K* a = p.data();
+    const K* b = q.data();
+    K* c = r.data();
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<K, float>) {
+        // r = w1·(x2 y2 z2 w2) + x1·(w2 -z2 y2 -x2) + y1·(z2 w2 -x2 -y2) + z1·(-y2 x2 w2 -z2)
+        __m128 va = _mm_loadu_ps(a);
+        __m128 vb = _mm_loadu_ps(b);
+        __m128 v = _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 3, 3, 3)), vb);
+        __m128 t = _mm_xor_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3)), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(0, 0, 0, 0)), t));
+        t = _mm_xor_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(1, 0, 3, 2)), _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(1, 1, 1, 1)), t));
+        t = _mm_xor_ps(_mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1)), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 2, 2, 2)), t));
+        _mm_storeu_ps(c, v);
+        return r;
+    }
+#endif
+    c[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    c[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    c[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    c[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+    return r;
+}
+
+/**
+ * @brief Spherical linear interpolation between unit quaternions
+ *
+ * Follows the shorter arc (q and -q are the same rotation). When the two
+ * rotations are within about 0.2° of each other the normalised linear blend
+ * is used instead, as sin θ is then too small to divide by.
+ *
+ * @param t 0 gives p, 1 gives q
+ */
+template <typename K>
+Quaternion<K> slerp(const Quaternion<K>& p, const Quaternion<K>& q, K t)
+{
+    K d = dot(p, q);
+    K sign = d < K(0) ? K(-1) : K(1);
+    d *= sign;
+    K s0, s1;
+    if (d > K(1) - K(1e-6)) {
+        s0 = K(1) - t;
+        s1 = t;
+    } else {
+        K theta = std::acos(d);
+        K inv = K(1) / std::sin(theta);
+        s0 = std::sin((K(1) - t) * theta) * inv;
+        s1 = std::sin(t * theta) * inv;
+    }
+    s1 *= sign;
+    Quaternion<K> r;
+    const K* a = p.data();
+    const K* b = q.data();
+    K* c = r.data();
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<K, float>) {
+        _mm_storeu_ps(c, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s0), _mm_loadu_ps(a)),
+                                    _mm_mul_ps(_mm_set1_ps(s1), _mm_loadu_ps(b))));
+        r.normalize();
+        return r;
+    }
+#endif
+    for (size_t i = 0; i < 4; ++i)
+        c[i] = s0 * a[i] + s1 * b[i];
+    r.normalize();
+    return r;
+}
+
+/**
+ * @brief o[i] = q·(x[i], y[i], z[i])·q⁻¹ for n vectors stored as separate x, y, z arrays
+ *
+ * The outputs may alias the inputs element for element.
+ */
+template <typename K>
+void rotate_batch(const Quaternion<K>& q, const K* x, const K* y, const K* z,
+                  K* ox, K* oy, K* oz, size_t n)
+{
+    K m[9];
+    q.coefficients(m);
+    size_t i = 0;
+    if constexpr (std::is_same_v<K, float>) {
+#if defined(__AVX__)
+        __m256 m8[9];
+        for (size_t k = 0; k < 9; ++k)
+            m8[k] = _mm256_set1_ps(m[k]);
+        for (; i + 8 <= n; i += 8) {
+            __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+            __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m8[0], vx), _mm256_mul_ps(m8[1], vy)),
+                                      _mm256_mul_ps(m8[2], vz));
+            __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m8[3], vx), _mm256_mul_ps(m8[4], vy)),
+                                      _mm256_mul_ps(m8[5], vz));
+            __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m8[6], vx), _mm256_mul_ps(m8[7], vy)),
+                                      _mm256_mul_ps(m8[8], vz));
+            _mm256_storeu_ps(ox + i, rx);
+            _mm256_storeu_ps(oy + i, ry);
+            _mm256_storeu_ps(oz + i, rz);
+        }
+#endif
+#if defined(__SSE2__)
+        __m128 m4[9];
+        for (size_t k = 0; k < 9; ++k)
+            m4[k] = _mm_set1_ps(m[k]);
+        for (; i + 4 <= n; i += 4) {
+            __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m4[0], vx), _mm_mul_ps(m4[1], vy)), _mm_mul_ps(m4[2], vz));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m4[3], vx), _mm_mul_ps(m4[4], vy)), _mm_mul_ps(m4[5], vz));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m4[6], vx), _mm_mul_ps(m4[7], vy)), _mm_mul_ps(m4[8], vz));
+            _mm_storeu_ps(ox + i, rx);
+            _mm_storeu_ps(oy + i, ry);
+            _mm_storeu_ps(oz + i, rz);
+        }
+#endif
+    }
+    for (; i < n; ++i) {
+        K vx = x[i], vy = y[i], vz = z[i];
+        ox[i] = m[0] * vx + m[1] * vy + m[2] * vz;
+        oy[i] = m[3] * vx + m[4] * vy + m[5] * vz;
+        oz[i] = m[6] * vx + m[7] * vy + m[8] * vz;
+    }
+}
+
+/**
+ * @brief Rotates every point of `in` into `out`
+ *
+ * @param out Resized to in.size(); may be `in` itself
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ */
+template <typename K>
+void rotate(const Quaternion<K>& q, const Points3<K>& in, Points3<K>& out, size_t threads = 0)
+{
+    size_t n = in.size();
+    out.resize(n);
+    parallel_for(0, n, MESH_TILE, [&](size_t lo, size_t hi) {
+        rotate_batch(q, in.x.data() + lo, in.y.data() + lo, in.z.data() + lo,
+                     out.x.data() + lo, out.y.data() + lo, out.z.data() + lo, hi - lo);
+    }, threads);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+* Reduction kernels behind dot(), norm(), norm_1(), norm_inf() and Vector::max().
+*
+* Every kernel takes the element count and a functor returning the i-th term,
+* so the same code sums a·b products, |x|² or |x|. A single accumulator makes
+* each add wait for the previous one (one add per FP latency) and its rounding
+* error grows linearly with n, which shows on long f32 vectors. The modes:
+*  - Fast:     four independent accumulators, combined at the end. Same cost
+*              as the naive loop but the adds can overlap.
+*  - Pairwise: the range is halved recursively down to blocks of
+*              REDUCTION_BLOCK terms summed with the Fast kernel. The error
+*              grows with log n instead of n, at almost the same speed.
+*  - Kahan:    Kahan's compensated sum, error independent of n. About four
+*              times slower; meant for ill-conditioned sums. Must not be built
+*              with -ffast-math, which folds the compensation away.
+*/
+
+enum class Summation {
+    Fast,
+    Pairwise,
+    Kahan
+};
+
+const size_t REDUCTION_BLOCK = 128;
+
+// Σ term(i) for i in [lo, hi) with four independent accumulators
+template <typename T, typename F>
+T sum_unrolled(const F& term, size_t lo, size_t hi)
+{
+    T s0 = T(0);
+    T s1 = T(0);
+    T s2 = T(0);
+    T s3 = T(0);
+    size_t i = lo;
+    for (; i + 4 <= hi; i += 4) {
+        s0 += term(i);
+        s1 += term(i + 1);
+        s2 += term(i + 2);
+        s3 += term(i + 3);
+    }
+    for (; i < hi; ++i)
+        s0 += term(i);
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Σ term(i) for i in [lo, hi), halving the range down to REDUCTION_BLOCK terms
+template <typename T, typename F>
+T sum_pairwise(const F& term, size_t lo, size_t hi)
+{
+    if (hi - lo <= REDUCTION_BLOCK)
+        return sum_unrolled<T>(term, lo, hi);
+    size_t mid = lo + (hi - lo) / 2;
+    return sum_pairwise<T>(term, lo, mid) + sum_pairwise<T>(term, mid, hi);
+}
+
+// Σ term(i) for i in [lo, hi) with Kahan compensation: the low-order bits lost
+// by each add are kept in comp and fed back into the next term
+template <typename T, typename F>
+T sum_compensated(const F& term, size_t lo, size_t hi)
+{
+    T sum = T(0);
+    T comp = T(0);
+    for (size_t i = lo; i < hi; ++i) {
+        T y = term(i) - comp;
+        T t = sum + y;
+        comp = (t - sum) - y;
+        sum = t;
+    }
+    return sum;
+}
+
+/**
+ * @brief Σ term(i) for i in [0, n) using the requested summation mode
+ *
+ * @tparam T Accumulator type
+ * @param n Number of terms
+ * @param term Functor returning the i-th term as T
+ * @param mode Accuracy/speed trade-off, see the top of this file
+ * @return T The sum, T(0) when n is 0
+ */
+template <typename T, typename F>
+T reduce_sum(size_t n, const F& term, Summation mode = Summation::Fast)
+{
+    switch (mode) {
+        case Summation::Pairwise:
+            return sum_pairwise<T>(term, 0, n);
+        case Summation::Kahan:
+            return sum_compensated<T>(term, 0, n);
+        default:
+            return sum_unrolled<T>(term, 0, n);
+    }
+}
+
+/**
+ * @brief max term(i) for i in [0, n) with four independent running maxima
+ *
+ * Comparisons keep the serial semantics: a later value replaces the maximum
+ * only if it compares greater, so a NaN term is skipped unless it is term(0).
+ *
+ * @param n Number of terms, must be at least 1
+ */
+template <typename T, typename F>
+T reduce_max(size_t n, const F& term)
+{
+    T m0 = term(0);
+    T m1 = m0;
+    T m2 = m0;
+    T m3 = m0;
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        T x0 = term(i);
+        T x1 = term(i + 1);
+        T x2 = term(i + 2);
+        T x3 = term(i + 3);
+        m0 = x0 > m0 ? x0 : m0;
+        m1 = x1 > m1 ? x1 : m1;
+        m2 = x2 > m2 ? x2 : m2;
+        m3 = x3 > m3 ? x3 : m3;
+    }
+    for (; i < n; ++i) {
+        T x = term(i);
+        m0 = x > m0 ? x : m0;
+    }
+    m0 = m1 > m0 ? m1 : m0;
+    m0 = m2 > m0 ? m2 : m0;
+    return m3 > m0 ? m3 : m0;
+}
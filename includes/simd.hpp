@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+* Single entry point for the x86 intrinsics headers.
+*
+* GCC 12 reports -Wuninitialized / -Wmaybe-uninitialized inside its own
+* AVX-512 headers (the `__Y = __Y` idiom of _mm512_undefined_*), which breaks
+* -Werror builds with -march=native. The diagnostics are silenced for the
+* header lines only, user code is still checked.
+*/
+
+#if defined(__SSE2__)
+# if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wuninitialized"
+#  pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+# endif
+# include <immintrin.h>
+# if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+# endif
+#endif
@@ -0,0 +1,528 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "vector.hpp"
+#include "utils.hpp"
+#include <cmath>
+#include <vector>
+
+/*
+* Iterative Krylov solvers for A·x = b.
+*
+* The operator A can be any type for which `mul_vec(A, x, out)` is callable
+* (found by argument dependent lookup), so a Matrix<K> works out of the box and
+* a user sparse or matrix-free operator only needs to provide that overload.
+* Preconditioners expose `apply(r, z)` computing z = M⁻¹·r.
+*
+* Every solver takes a KrylovWorkspace holding all of its scratch vectors:
+* once the workspace has been sized by a first solve, further solves of the
+* same dimension do not allocate inside the iteration loop.
+*/
+
+/**
+ * @brief Stopping criteria shared by the Krylov solvers
+ *
+ * The iteration stops once ||b - A·x|| <= tol·||b||.
+ * `restart` is only used by GMRES (size of the Krylov basis before restarting).
+ */
+template <typename K>
+struct SolverOptions {
+    K tol = K(1e-6);
+    size_t max_iter = 1000;
+    size_t restart = 30;
+};
+
+/**
+ * @brief Outcome of an iterative solve
+ *
+ * `residuals` holds the relative residual ||r||/||b|| of the starting guess
+ * followed by one entry per iteration.
+ */
+template <typename K>
+struct SolverResult {
+    bool converged = false;
+    size_t iterations = 0;
+    std::vector<K> residuals;
+};
+
+/**
+ * @brief Scratch buffers reused across iterations and across solves
+ */
+template <typename K>
+struct KrylovWorkspace {
+    Vector<K> r, r_hat, p, z, q, s, t, y;
+    std::vector<Vector<K>> basis;     // GMRES Arnoldi basis
+    std::vector<K> hessenberg;        // GMRES (restart + 1) x restart, row-major
+    std::vector<K> cs, sn, g, coefs;  // GMRES Givens rotations, rhs and solution
+
+    /**
+     * @brief Sizes every buffer for a system of dimension n
+     *
+     * Buffers that already have the right size are left untouched, so calling
+     * this before each solve costs nothing once the workspace is warm.
+     */
+    void reserve(size_t n, size_t restart = 0)
+    {
+        Vector<K>* vecs[] = {&r, &r_hat, &p, &z, &q, &s, &t, &y};
+        for (Vector<K>* v : vecs)
+            if (v->getSize() != n)
+                v->resize(n);
+        if (restart == 0)
+            return;
+        if (basis.size() != restart + 1)
+            basis.resize(restart + 1);
+        for (Vector<K>& v : basis)
+            if (v.getSize() != n)
+                v.resize(n);
+        hessenberg.resize((restart + 1) * restart);
+        cs.resize(restart);
+        sn.resize(restart);
+        g.resize(restart + 1);
+        coefs.resize(restart);
+    }
+};
+
+/**
+ * @brief No-op preconditioner (M = I)
+ */
+template <typename K>
+struct IdentityPreconditioner {
+    void apply(const Vector<K>& r, Vector<K>& z) const
+    {
+        const K* src = r.data();
+        K* dst = z.data();
+        for (size_t i = 0; i < r.getSize(); ++i)
+            dst[i] = src[i];
+    }
+};
+
+/**
+ * @brief Jacobi (diagonal) preconditioner: M = diag(A)
+ */
+template <typename K>
+class JacobiPreconditioner {
+
+    private :
+        std::vector<K> _inv_diag;
+
+    public:
+        /**
+         * @brief Stores the inverse of the diagonal of A
+         * @param A A square matrix
+         * @throws std::invalid_argument If A is not square
+         * @throws std::runtime_error If a diagonal entry is zero
+         */
+        explicit JacobiPreconditioner(const Matrix<K>& A)
+        {
+            if (A.getRows() != A.getCols())
+                throw std::invalid_argument("Matrix must be square");
+            _inv_diag.resize(A.getRows());
+            for (size_t i = 0; i < A.getRows(); ++i) {
+                if (A[i][i] == K(0))
+                    throw std::runtime_error("Jacobi preconditioner needs a non-zero diagonal");
+                _inv_diag[i] = K(1) / A[i][i];
+            }
+        }
+
+        void apply(const Vector<K>& r, Vector<K>& z) const
+        {
+            const K* src = r.data();
+            K* dst = z.data();
+            for (size_t i = 0; i < _inv_diag.size(); ++i)
+                dst[i] = src[i] * _inv_diag[i];
+        }
+};
+
+/**
+ * @brief Incomplete LU factorisation with zero fill-in: M = L·U
+ *
+ * L and U keep the sparsity pattern of A (the non-zero entries of the matrix),
+ * so the factors take no more memory than A itself and applying M⁻¹ costs two
+ * triangular sweeps over the stored entries. The factors are kept in CSR form
+ * (row offsets, column indices, values) with L unit-diagonal.
+ */
+template <typename K>
+class ILU0Preconditioner {
+
+    private :
+        std::vector<size_t> _row_ptr;
+        std::vector<size_t> _cols;
+        std::vector<size_t> _diag;   // position of the diagonal entry in each row
+        std::vector<K> _vals;
+
+    public:
+        /**
+         * @brief Computes the ILU(0) factors of A
+         * @param A A square matrix whose non-zero pattern defines the factors
+         * @throws std::invalid_argument If A is not square
+         * @throws std::runtime_error If a zero pivot is met
+         */
+        explicit ILU0Preconditioner(const Matrix<K>& A)
+        {
+            if (A.getRows() != A.getCols())
+                throw std::invalid_argument("Matrix must be square");
+            size_t n = A.getRows();
+
+            _row_ptr.assign(1, 0);
+            _diag.assign(n, 0);
+            for (size_t i = 0; i < n; ++i) {
+                bool has_diag = false;
+                for (size_t j = 0; j < n; ++j) {
+                    if (A[i][j] != K(0) || i == j) {
+                        if (i == j) {
+                            _diag[i] = _cols.size();
+                            has_diag = A[i][j] != K(0);
+                        }
+                        _cols.push_back(j);
+                        _vals.push_back(A[i][j]);
+                    }
+                }
+                if (!has_diag)
+                    throw std::runtime_error("ILU(0) needs a non-zero diagonal");
+                _row_ptr.push_back(_cols.size());
+            }
+
+            // IKJ variant restricted to the pattern; `pos` maps a column to
+            // its slot in the current row, or n when it is not stored.
+            std::vector<size_t> pos(n, n);
+            for (size_t i = 1; i < n; ++i) {
+                for (size_t e = _row_ptr[i]; e < _row_ptr[i + 1]; ++e)
+                    pos[_cols[e]] = e;
+                for (size_t e = _row_ptr[i]; e < _diag[i]; ++e) {
+                    size_t k = _cols[e];
+                    _vals[e] /= _vals[_diag[k]];
+                    K f = _vals[e];
+                    for (size_t ke = _diag[k] + 1; ke < _row_ptr[k + 1]; ++ke)
+                        if (pos[_cols[ke]] != n)
+                            _vals[pos[_cols[ke]]] -= f * _vals[ke];
+                }
+                if (_vals[_diag[i]] == K(0))
+                    throw std::runtime_error("ILU(0) met a zero pivot");
+                for (size_t e = _row_ptr[i]; e < _row_ptr[i + 1]; ++e)
+                    pos[_cols[e]] = n;
+            }
+        }
+
+        /**
+         * @brief Solves L·U·z = r (forward then backward substitution)
+         */
+        void apply(const Vector<K>& r, Vector<K>& z) const
+        {
+            size_t n = _diag.size();
+            const K* src = r.data();
+            K* dst = z.data();
+            for (size_t i = 0; i < n; ++i) {
+                K sum = src[i];
+                for (size_t e = _row_ptr[i]; e < _diag[i]; ++e)
+                    sum -= _vals[e] * dst[_cols[e]];
+                dst[i] = sum;
+            }
+            for (size_t i = n; i-- > 0;) {
+                K sum = dst[i];
+                for (size_t e = _diag[i] + 1; e < _row_ptr[i + 1]; ++e)
+                    sum -= _vals[e] * dst[_cols[e]];
+                dst[i] = sum / _vals[_diag[i]];
+            }
+        }
+};
+
+// Writes r = b - A·x using `tmp` as scratch and returns ||r||
+template <typename Op, typename K>
+K krylov_residual(const Op& A, const Vector<K>& b, const Vector<K>& x, Vector<K>& r, Vector<K>& tmp)
+{
+    mul_vec(A, x, tmp);
+    const K* pb = b.data();
+    const K* pt = tmp.data();
+    K* pr = r.data();
+    for (size_t i = 0; i < b.getSize(); ++i)
+        pr[i] = pb[i] - pt[i];
+    return norm(r);
+}
+
+/**
+ * @brief Preconditioned conjugate gradient
+ *
+ * Solves A·x = b for a symmetric positive definite A (and SPD preconditioner),
+ * starting from the value already stored in x.
+ *
+ * @param A The operator, used through mul_vec(A, x, out)
+ * @param b The right hand side
+ * @param x The initial guess, overwritten with the solution
+ * @param M The preconditioner
+ * @param ws Scratch buffers, sized on first use
+ * @param opts Tolerance and iteration limit
+ * @return SolverResult<K> Convergence flag, iteration count and residual history
+ * @throws std::invalid_argument If b and x sizes differ
+ */
+template <typename Op, typename K, typename Precond>
+SolverResult<K> cg(const Op& A, const Vector<K>& b, Vector<K>& x, const Precond& M,
+                   KrylovWorkspace<K>& ws, const SolverOptions<K>& opts = SolverOptions<K>())
+{
+    if (b.getSize() != x.getSize())
+        throw std::invalid_argument("The vectors must have the same size.");
+    SolverResult<K> res;
+    res.residuals.reserve(opts.max_iter + 1);
+    ws.reserve(b.getSize());
+
+    K b_norm = norm(b);
+    if (b_norm == K(0))
+        b_norm = K(1);
+    K r_norm = krylov_residual(A, b, x, ws.r, ws.q);
+    res.residuals.push_back(r_norm / b_norm);
+    if (r_norm <= opts.tol * b_norm) {
+        res.converged = true;
+        return res;
+    }
+
+    M.apply(ws.r, ws.z);
+    M.apply(ws.r, ws.p);
+    K rz = dot(ws.r, ws.z);
+    while (res.iterations < opts.max_iter) {
+        mul_vec(A, ws.p, ws.q);
+        K pq = dot(ws.p, ws.q);
+        if (pq == K(0))
+            break;
+        K alpha = rz / pq;
+        axpy(alpha, ws.p, x);
+        axpy(-alpha, ws.q, ws.r);
+        ++res.iterations;
+
+        r_norm = norm(ws.r);
+        res.residuals.push_back(r_norm / b_norm);
+        if (r_norm <= opts.tol * b_norm) {
+            res.converged = true;
+            break;
+        }
+
+        M.apply(ws.r, ws.z);
+        K rz_new = dot(ws.r, ws.z);
+        K beta = rz_new / rz;
+        rz = rz_new;
+        K* p = ws.p.data();
+        const K* z = ws.z.data();
+        for (size_t i = 0; i < ws.p.getSize(); ++i)
+            p[i] = z[i] + beta * p[i];
+    }
+    return res;
+}
+
+/**
+ * @brief Right-preconditioned restarted GMRES(m)
+ *
+ * Works for any non-singular A. The Arnoldi basis is restarted every
+ * opts.restart iterations; the least squares problem is updated with Givens
+ * rotations so the residual norm is known at every step without forming x.
+ *
+ * @param A The operator, used through mul_vec(A, x, out)
+ * @param b The right hand side
+ * @param x The initial guess, overwritten with the solution
+ * @param M The preconditioner, applied on the right (A·M⁻¹·u = b, x = M⁻¹·u)
+ * @param ws Scratch buffers, sized on first use
+ * @param opts Tolerance, iteration limit and restart length
+ * @return SolverResult<K> Convergence flag, iteration count and residual history
+ * @throws std::invalid_argument If b and x sizes differ or restart is 0
+ */
+template <typename Op, typename K, typename Precond>
+SolverResult<K> gmres(const Op& A, const Vector<K>& b, Vector<K>& x, const Precond& M,
+                      KrylovWorkspace<K>& ws, const SolverOptions<K>& opts = SolverOptions<K>())
+{
+    if (b.getSize() != x.getSize())
+        throw std::invalid_argument("The vectors must have the same size.");
+    if (opts.restart == 0)
+        throw std::invalid_argument("GMRES restart length must be greater than 0");
+    size_t n = b.getSize();
+    size_t m = opts.restart;
+    SolverResult<K> res;
+    res.residuals.reserve(opts.max_iter + 1);
+    ws.reserve(n, m);
+    K* H = ws.hessenberg.data();
+
+    K b_norm = norm(b);
+    if (b_norm == K(0))
+        b_norm = K(1);
+    K r_norm = krylov_residual(A, b, x, ws.r, ws.q);
+    res.residuals.push_back(r_norm / b_norm);
+
+    while (r_norm > opts.tol * b_norm && res.iterations < opts.max_iter) {
+        for (size_t i = 0; i < n; ++i)
+            ws.basis[0][i] = ws.r[i] / r_norm;
+        for (size_t i = 0; i <= m; ++i)
+            ws.g[i] = K(0);
+        ws.g[0] = r_norm;
+
+        size_t j = 0;
+        while (j < m && res.iterations < opts.max_iter) {
+            // w = A·M⁻¹·v_j, orthogonalised against the basis (modified Gram-Schmidt)
+            M.apply(ws.basis[j], ws.z);
+            mul_vec(A, ws.z, ws.basis[j + 1]);
+            Vector<K>& w = ws.basis[j + 1];
+            for (size_t i = 0; i <= j; ++i) {
+                K h = dot(w, ws.basis[i]);
+                H[i * m + j] = h;
+                axpy(-h, ws.basis[i], w);
+            }
+            K h_next = norm(w);
+            H[(j + 1) * m + j] = h_next;
+            if (h_next != K(0))
+                w.scl(K(1) / h_next);
+
+            for (size_t i = 0; i < j; ++i) {
+                K a = H[i * m + j];
+                K c = H[(i + 1) * m + j];
+                H[i * m + j] = ws.cs[i] * a + ws.sn[i] * c;
+                H[(i + 1) * m + j] = -ws.sn[i] * a + ws.cs[i] * c;
+            }
+            K a = H[j * m + j];
+            K c = H[(j + 1) * m + j];
+            K d = std::sqrt(a * a + c * c);
+            ws.cs[j] = d == K(0) ? K(1) : a / d;
+            ws.sn[j] = d == K(0) ? K(0) : c / d;
+            H[j * m + j] = d;
+            H[(j + 1) * m + j] = K(0);
+            ws.g[j + 1] = -ws.sn[j] * ws.g[j];
+            ws.g[j] = ws.cs[j] * ws.g[j];
+
+            ++j;
+            ++res.iterations;
+            r_norm = std::fabs(ws.g[j]);
+            res.residuals.push_back(r_norm / b_norm);
+            if (r_norm <= opts.tol * b_norm || h_next == K(0))
+                break;
+        }
+
+        // Back substitution on the j x j triangle, then x += M⁻¹·(V·y)
+        for (size_t i = j; i-- > 0;) {
+            K sum = ws.g[i];
+            for (size_t k = i + 1; k < j; ++k)
+                sum -= H[i * m + k] * ws.coefs[k];
+            ws.coefs[i] = sum / H[i * m + i];
+        }
+        for (size_t i = 0; i < n; ++i)
+            ws.y[i] = K(0);
+        for (size_t i = 0; i < j; ++i)
+            axpy(ws.coefs[i], ws.basis[i], ws.y);
+        M.apply(ws.y, ws.z);
+        axpy(K(1), ws.z, x);
+
+        // Replace the recurrence estimate by the true residual before restarting
+        r_norm = krylov_residual(A, b, x, ws.r, ws.q);
+        res.residuals.back() = r_norm / b_norm;
+    }
+    res.converged = r_norm <= opts.tol * b_norm;
+    return res;
+}
+
+/**
+ * @brief Right-preconditioned BiCGSTAB
+ *
+ * Works for non-symmetric A with short recurrences (constant memory, two
+ * operator and two preconditioner applications per iteration). A breakdown
+ * (rho or omega reaching zero) stops the iteration with converged = false.
+ *
+ * @param A The operator, used through mul_vec(A, x, out)
+ * @param b The right hand side
+ * @param x The initial guess, overwritten with the solution
+ * @param M The preconditioner
+ * @param ws Scratch buffers, sized on first use
+ * @param opts Tolerance and iteration limit
+ * @return SolverResult<K> Convergence flag, iteration count and residual history
+ * @throws std::invalid_argument If b and x sizes differ
+ */
+template <typename Op, typename K, typename Precond>
+SolverResult<K> bicgstab(const Op& A, const Vector<K>& b, Vector<K>& x, const Precond& M,
+                         KrylovWorkspace<K>& ws, const SolverOptions<K>& opts = SolverOptions<K>())
+{
+    if (b.getSize() != x.getSize())
+        throw std::invalid_argument("The vectors must have the same size.");
+    size_t n = b.getSize();
+    SolverResult<K> res;
+    res.residuals.reserve(opts.max_iter + 1);
+    ws.reserve(n);
+
+    K b_norm = norm(b);
+    if (b_norm == K(0))
+        b_norm = K(1);
+    K r_norm = krylov_residual(A, b, x, ws.r, ws.q);
+    res.residuals.push_back(r_norm / b_norm);
+    if (r_norm <= opts.tol * b_norm) {
+        res.converged = true;
+        return res;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        ws.r_hat[i] = ws.r[i];
+        ws.p[i] = K(0);
+        ws.q[i] = K(0);   // q holds v = A·M⁻¹·p
+    }
+    K rho = 1, alpha = 1, omega = 1;
+    while (res.iterations < opts.max_iter) {
+        K rho_new = dot(ws.r_hat, ws.r);
+        if (rho_new == K(0) || omega == K(0))
+            break;
+        K beta = (rho_new / rho) * (alpha / omega);
+        rho = rho_new;
+        for (size_t i = 0; i < n; ++i)
+            ws.p[i] = ws.r[i] + beta * (ws.p[i] - omega * ws.q[i]);
+
+        M.apply(ws.p, ws.y);
+        mul_vec(A, ws.y, ws.q);
+        K rv = dot(ws.r_hat, ws.q);
+        if (rv == K(0))
+            break;
+        alpha = rho / rv;
+        for (size_t i = 0; i < n; ++i)
+            ws.s[i] = ws.r[i] - alpha * ws.q[i];
+        axpy(alpha, ws.y, x);
+        ++res.iterations;
+
+        K s_norm = norm(ws.s);
+        if (s_norm <= opts.tol * b_norm) {
+            res.residuals.push_back(s_norm / b_norm);
+            res.converged = true;
+            break;
+        }
+
+        M.apply(ws.s, ws.z);
+        mul_vec(A, ws.z, ws.t);
+        K tt = dot(ws.t, ws.t);
+        omega = tt == K(0) ? K(0) : dot(ws.t, ws.s) / tt;
+        axpy(omega, ws.z, x);
+        for (size_t i = 0; i < n; ++i)
+            ws.r[i] = ws.s[i] - omega * ws.t[i];
+
+        r_norm = norm(ws.r);
+        res.residuals.push_back(r_norm / b_norm);
+        if (r_norm <= opts.tol * b_norm) {
+            res.converged = true;
+            break;
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief Unpreconditioned conveniences using a temporary workspace
+ */
+template <typename Op, typename K>
+SolverResult<K> cg(const Op& A, const Vector<K>& b, Vector<K>& x,
+                   const SolverOptions<K>& opts = SolverOptions<K>())
+{
+    KrylovWorkspace<K> ws;
+    return cg(A, b, x, IdentityPreconditioner<K>(), ws, opts);
+}
+
+template <typename Op, typename K>
+SolverResult<K> gmres(const Op& A, const Vector<K>& b, Vector<K>& x,
+                      const SolverOptions<K>& opts = SolverOptions<K>())
+{
+    KrylovWorkspace<K> ws;
+    return gmres(A, b, x, IdentityPreconditioner<K>(), ws, opts);
+}
+
+template <typename Op, typename K>
+SolverResult<K> bicgstab(const Op& A, const Vector<K>& b, Vector<K>& x,
+                         const SolverOptions<K>& opts = SolverOptions<K>())
+{
+    KrylovWorkspace<K> ws;
+    return bicgstab(A, b, x, IdentityPreconditioner<K>(), ws, opts);
+}
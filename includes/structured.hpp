@@ -0,0 +1,346 @@
+#pragma once
+
+#include "complex.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+* Identity, diagonal and permutation matrices.
+*
+* None of them stores its n x n elements: an Identity is its size, a Diagonal
+* its n diagonal entries and a Permutation the row index each row is taken
+* from. The overloads of mul_mat(), mul_vec(), add() and inverse() below
+* combine them with a dense Matrix in O(n) or O(n²), the cost of reading or
+* writing the dense operand, instead of the O(n³) of a dense product with a
+* materialised matrix. to_dense() is there for interoperability only.
+*/
+
+class Identity {
+
+    private:
+        size_t _n;
+
+    public:
+        explicit Identity(size_t n) : _n(n) {}
+
+        size_t size() const { return _n; }
+
+        template <typename K>
+        Matrix<K> to_dense() const
+        {
+            Matrix<K> I(std::vector<std::vector<K>>(_n, std::vector<K>(_n)));
+            for (size_t i = 0; i < _n; ++i)
+                I[i][i] = K(1);
+            return I;
+        }
+};
+
+template <typename K>
+class Diagonal {
+
+    private:
+        std::vector<K> _diag;
+
+    public:
+        explicit Diagonal(std::vector<K> diag) : _diag(std::move(diag)) {}
+        explicit Diagonal(const Vector<K>& diag) : _diag(diag.data(), diag.data() + diag.getSize()) {}
+        Diagonal(size_t n, K value) : _diag(n, value) {}
+
+        size_t size() const { return _diag.size(); }
+        K& operator[](size_t i) { return _diag[i]; }
+        const K& operator[](size_t i) const { return _diag[i]; }
+
+        Matrix<K> to_dense() const
+        {
+            Matrix<K> D(std::vector<std::vector<K>>(size(), std::vector<K>(size())));
+            for (size_t i = 0; i < size(); ++i)
+                D[i][i] = _diag[i];
+            return D;
+        }
+};
+
+/**
+ * @brief Permutation matrix P: row i of P·A is row perm[i] of A
+ *
+ * Same convention as LU::permutation(), so Permutation(lu.permutation())
+ * is the P of P·A = L·U.
+ */
+class Permutation {
+
+    private:
+        std::vector<size_t> _perm;
+        int _sign;
+
+    public:
+        explicit Permutation(size_t n) : _perm(n), _sign(1)
+        {
+            for (size_t i = 0; i < n; ++i)
+                _perm[i] = i;
+        }
+
+        /**
+         * @throws std::invalid_argument If perm is not a permutation of 0..n-1
+         */
+        explicit Permutation(std::vector<size_t> perm) : _perm(std::move(perm)), _sign(1)
+        {
+            std::vector<bool> seen(_perm.size());
+            for (size_t p : _perm) {
+                if (p >= _perm.size() || seen[p])
+                    throw std::invalid_argument("Invalid permutation");
+                seen[p] = true;
+            }
+            // Parity from the cycle lengths: a cycle of length l is l - 1 transpositions
+            std::vector<bool> visited(_perm.size());
+            for (size_t i = 0; i < _perm.size(); ++i) {
+                size_t length = 0;
+                for (size_t j = i; !visited[j]; j = _perm[j], ++length)
+                    visited[j] = true;
+                if (length && length % 2 == 0)
+                    _sign = -_sign;
+            }
+        }
+
+        size_t size() const { return _perm.size(); }
+        size_t operator[](size_t i) const { return _perm[i]; }
+        const std::vector<size_t>& indices() const { return _perm; }
+        int sign() const { return _sign; }
+
+        // Exchanges rows i and j of P
+        void swap(size_t i, size_t j)
+        {
+            if (i != j) {
+                std::swap(_perm[i], _perm[j]);
+                _sign = -_sign;
+            }
+        }
+
+        template <typename K>
+        Matrix<K> to_dense() const
+        {
+            Matrix<K> P(std::vector<std::vector<K>>(size(), std::vector<K>(size())));
+            for (size_t i = 0; i < size(); ++i)
+                P[i][_perm[i]] = K(1);
+            return P;
+        }
+};
+
+// Size checks: rows and columns of a dense operand, 0 columns for an empty matrix
+template <typename K>
+void check_structured(size_t n, const Matrix<K>& M, bool left)
+{
+    size_t inner = left ? M.getRows() : (M.getRows() ? M.getCols() : 0);
+    if (inner != n)
+        throw std::invalid_argument("The matrix sizes don't match.");
+}
+
+inline void check_structured(size_t n, size_t m)
+{
+    if (n != m)
+        throw std::invalid_argument("The matrix sizes don't match.");
+}
+
+/*
+* Products. The structured operand on the left acts on rows, on the right on
+* columns.
+*/
+
+template <typename K>
+Matrix<K> mul_mat(const Identity& I, const Matrix<K>& M)
+{
+    check_structured(I.size(), M, true);
+    return M;
+}
+
+template <typename K>
+Matrix<K> mul_mat(const Matrix<K>& M, const Identity& I)
+{
+    check_structured(I.size(), M, false);
+    return M;
+}
+
+// D·M scales row i by d[i]
+template <typename K>
+Matrix<K> mul_mat(const Diagonal<K>& D, const Matrix<K>& M)
+{
+    check_structured(D.size(), M, true);
+    Matrix<K> R(M);
+    for (size_t i = 0; i < R.getRows(); ++i)
+        for (K& x : R[i])
+            x *= D[i];
+    return R;
+}
+
+// M·D scales column j by d[j]
+template <typename K>
+Matrix<K> mul_mat(const Matrix<K>& M, const Diagonal<K>& D)
+{
+    check_structured(D.size(), M, false);
+    Matrix<K> R(M);
+    for (size_t i = 0; i < R.getRows(); ++i) {
+        K* r = R[i].data();
+        for (size_t j = 0; j < D.size(); ++j)
+            r[j] *= D[j];
+    }
+    return R;
+}
+
+template <typename K>
+Diagonal<K> mul_mat(const Diagonal<K>& D, const Diagonal<K>& E)
+{
+    check_structured(D.size(), E.size());
+    Diagonal<K> R(E);
+    for (size_t i = 0; i < R.size(); ++i)
+        R[i] = D[i] * E[i];
+    return R;
+}
+
+// P·M copies row perm[i] of M into row i
+template <typename K>
+Matrix<K> mul_mat(const Permutation& P, const Matrix<K>& M)
+{
+    check_structured(P.size(), M, true);
+    std::vector<std::vector<K>> rows(P.size());
+    for (size_t i = 0; i < P.size(); ++i)
+        rows[i] = M[P[i]];
+    return Matrix<K>(rows);
+}
+
+// M·P moves column k of M to column perm[k]
+template <typename K>
+Matrix<K> mul_mat(const Matrix<K>& M, const Permutation& P)
+{
+    check_structured(P.size(), M, false);
+    Matrix<K> R(M);
+    for (size_t i = 0; i < R.getRows(); ++i) {
+        const K* src = M[i].data();
+        K* dst = R[i].data();
+        for (size_t k = 0; k < P.size(); ++k)
+            dst[P[k]] = src[k];
+    }
+    return R;
+}
+
+// (P·Q)·A takes row q[p[i]] of A
+inline Permutation mul_mat(const Permutation& P, const Permutation& Q)
+{
+    check_structured(P.size(), Q.size());
+    std::vector<size_t> perm(P.size());
+    for (size_t i = 0; i < P.size(); ++i)
+        perm[i] = Q[P[i]];
+    return Permutation(perm);
+}
+
+template <typename K>
+Vector<K> mul_vec(const Identity& I, const Vector<K>& u)
+{
+    check_structured(I.size(), u.getSize());
+    return u;
+}
+
+template <typename K>
+Vector<K> mul_vec(const Diagonal<K>& D, const Vector<K>& u)
+{
+    check_structured(D.size(), u.getSize());
+    Vector<K> out(u);
+    K* y = out.data();
+    for (size_t i = 0; i < D.size(); ++i)
+        y[i] *= D[i];
+    return out;
+}
+
+template <typename K>
+Vector<K> mul_vec(const Permutation& P, const Vector<K>& u)
+{
+    check_structured(P.size(), u.getSize());
+    Vector<K> out{std::vector<K>(P.size())};
+    const K* x = u.data();
+    K* y = out.data();
+    for (size_t i = 0; i < P.size(); ++i)
+        y[i] = x[P[i]];
+    return out;
+}
+
+/*
+* Sums with a dense matrix only touch its diagonal.
+*/
+
+template <typename K>
+Matrix<K> add(const Matrix<K>& M, const Identity& I)
+{
+    check_structured(I.size(), M, true);
+    check_structured(I.size(), M, false);
+    Matrix<K> R(M);
+    for (size_t i = 0; i < I.size(); ++i)
+        R[i][i] += K(1);
+    return R;
+}
+
+template <typename K>
+Matrix<K> add(const Identity& I, const Matrix<K>& M)
+{
+    return add(M, I);
+}
+
+template <typename K>
+Matrix<K> add(const Matrix<K>& M, const Diagonal<K>& D)
+{
+    check_structured(D.size(), M, true);
+    check_structured(D.size(), M, false);
+    Matrix<K> R(M);
+    for (size_t i = 0; i < D.size(); ++i)
+        R[i][i] += D[i];
+    return R;
+}
+
+template <typename K>
+Matrix<K> add(const Diagonal<K>& D, const Matrix<K>& M)
+{
+    return add(M, D);
+}
+
+template <typename K>
+Diagonal<K> add(const Diagonal<K>& D, const Diagonal<K>& E)
+{
+    check_structured(D.size(), E.size());
+    Diagonal<K> R(E);
+    for (size_t i = 0; i < R.size(); ++i)
+        R[i] = D[i] + E[i];
+    return R;
+}
+
+inline Identity inverse(const Identity& I)
+{
+    return I;
+}
+
+/**
+ * @brief Element-wise reciprocal of the diagonal
+ * @throws std::runtime_error If a diagonal entry is at most 1e-10·max|di|
+ */
+template <typename K>
+Diagonal<K> inverse(const Diagonal<K>& D)
+{
+    real_t<K> scale = 0;
+    for (size_t i = 0; i < D.size(); ++i)
+        scale = std::max(scale, magnitude(D[i]));
+    Diagonal<K> R(D);
+    for (size_t i = 0; i < R.size(); ++i) {
+        if (!(magnitude(R[i]) > real_t<K>(1e-10) * scale))
+            throw std::runtime_error("Matrix is singular and cannot be inverted");
+        R[i] = K(1) / R[i];
+    }
+    return R;
+}
+
+// P⁻¹ = Pᵀ: the inverse permutation
+inline Permutation inverse(const Permutation& P)
+{
+    std::vector<size_t> perm(P.size());
+    for (size_t i = 0; i < P.size(); ++i)
+        perm[P[i]] = i;
+    return Permutation(perm);
+}
@@ -1,7 +1,62 @@
+#pragma once
+
 #include "matrix.hpp"
+#include "parallel.hpp"
 #include "vector.hpp"
+#include <algorithm>
 #include <cmath>
 
+/**
+ * @brief Accumulates Σ coefs[t]·u[t][j] into out[j] for j in [lo, hi)
+ * 
+ * The output chunk is walked once per group of four terms, so each element of
+ * `out` is loaded and stored N/4 times instead of N times and the four
+ * products are summed in registers. Callers pick chunks small enough for the
+ * output slice to stay in L1 between groups.
+ */
+template <typename K>
+void linear_combination_chunk(std::vector<Vector<K>> const &u, std::vector<K> const &coefs,
+                              K* out, size_t lo, size_t hi)
+{
+    size_t terms = u.size();
+    size_t t = 0;
+    for (size_t j = lo; j < hi; ++j)
+        out[j] = K(0);
+    for (; t + 4 <= terms; t += 4) {
+        const K* u0 = u[t].data();
+        const K* u1 = u[t + 1].data();
+        const K* u2 = u[t + 2].data();
+        const K* u3 = u[t + 3].data();
+        K c0 = coefs[t], c1 = coefs[t + 1], c2 = coefs[t + 2], c3 = coefs[t + 3];
+        for (size_t j = lo; j < hi; ++j)
+            out[j] += c0 * u0[j] + c1 * u1[j] + c2 * u2[j] + c3 * u3[j];
+    }
+    for (; t < terms; ++t) {
+        const K* ut = u[t].data();
+        K ct = coefs[t];
+        for (size_t j = lo; j < hi; ++j)
+            out[j] += ct * ut[j];
+    }
+}
+
+// Checks the shapes shared by both linear_combination variants, returns the vector size
+template <typename K>
+size_t linear_combination_check(std::vector<Vector<K>> const &u, std::vector<K> const &coefs)
+{
+    if (u.size() != coefs.size())
+        throw std::invalid_argument("The number of vectors and coefficients doesn't match !");
+    if (u.empty())
+        throw std::invalid_argument("Cannot compute a linear combination of 0 vectors");
+    size_t n = u[0].getSize();
+    for (size_t i = 1; i < u.size(); i++)
+        if (u[i].getSize() != n)
+            throw std::invalid_argument("The vectors must have the same size.");
+    return n;
+}
+
+// Output elements per chunk: 1024 floats (4 KiB) leave room in L1 for the term rows
+const size_t LINEAR_COMBINATION_CHUNK = 1024;
+
 /**
  * @brief Computes the linear combination of vectors
  * 
@@ -10,23 +65,55 @@
  * 
  * Used to describe vector space: 
  * V = [1, 0], U = [0, 1], a⋅V + b⋅U = (a, b)
+ * 
+ * The result is built in a single allocation: the output is processed in
+ * cache sized chunks and every chunk accumulates all the terms before moving
+ * on (see linear_combination_chunk), instead of one temporary and one full
+ * pass per term.
 
  * @tparam K The type of elements in the vectors and coefficients
  * @param u Vector of vectors to be combined
  * @param coefs Vector of coefficients to multiply each vector by
  * @return Vector<K> The resulting vector from the linear combination
- * @throws std::invalid_argument if the number of vectors doesn't match the number of coefficients
+ * @throws std::invalid_argument if the number of vectors doesn't match the number of coefficients,
+ *         if there are no vectors or if the vectors have different sizes
+ */
+template <typename K>
+Vector<K> linear_combination(std::vector<Vector<K>> const &u, std::vector<K> const &coefs)
+{
+    size_t n = linear_combination_check(u, coefs);
+    Vector<K> result;
+    result.resize(n);
+    for (size_t lo = 0; lo < n; lo += LINEAR_COMBINATION_CHUNK)
+        linear_combination_chunk(u, coefs, result.data(), lo, std::min(n, lo + LINEAR_COMBINATION_CHUNK));
+    return result;
+}
+
+/**
+ * @brief Multithreaded linear_combination for long vectors
  * 
- * @note Both input vectors must have the same size
+ * The output is split in contiguous slices, one per thread, and each thread
+ * runs the same chunked kernel on its slice. Vectors shorter than a few
+ * chunks per thread are computed on the calling thread.
+ * 
+ * @param u Vector of vectors to be combined
+ * @param coefs Vector of coefficients to multiply each vector by
+ * @param threads Maximum number of threads, 0 for hardware_threads()
+ * @return Vector<K> The resulting vector from the linear combination
+ * @throws std::invalid_argument Same conditions as linear_combination()
  */
 template <typename K>
-Vector<K> linear_combination(std::vector<Vector<K>> const &u, std::vector<K> coefs)
+Vector<K> linear_combination_parallel(std::vector<Vector<K>> const &u, std::vector<K> const &coefs,
+                                      size_t threads = 0)
 {
-    if (u.size() != coefs.size())
-        throw std::invalid_argument("The number of vectors and coefficients doesn't match !");
-    Vector<K> result = Vector<K>(u[0] * coefs[0]);
-    for (size_t i = 1; i < u.size(); i++)
-        result += (u[i] * coefs[i]);
+    size_t n = linear_combination_check(u, coefs);
+    Vector<K> result;
+    result.resize(n);
+    K* out = result.data();
+    parallel_for(0, n, 4 * LINEAR_COMBINATION_CHUNK, [&](size_t begin, size_t end) {
+        for (size_t lo = begin; lo < end; lo += LINEAR_COMBINATION_CHUNK)
+            linear_combination_chunk(u, coefs, out, lo, std::min(end, lo + LINEAR_COMBINATION_CHUNK));
+    }, threads);
     return result;
 }
 
@@ -45,7 +132,7 @@ Vector<K> linear_combination(std::vector<Vector<K>> const &u, std::vector<K> coe
 template <typename K>
 Vector<K> lerp(const Vector<K> &v, const Vector<K> &u, const K &t)
 {
-    return (1 - t) * v + t * u;
+    return (K(1) - t) * v + t * u;
 }
 
 /**
@@ -87,7 +174,7 @@ K lerp(const K &a, const K &b, const f32 &t)
 template <typename K>
 Matrix<K> lerp(const Matrix<K> &M, const Matrix<K> &N, const f32 &t)
 {
-    return M * (1 - t) + (N * t);
+    return M * K(1 - t) + (N * K(t));
 }
 
 
@@ -98,6 +185,9 @@ Matrix<K> lerp(const Matrix<K> &M, const Matrix<K> &N, const f32 &t)
  * - v·u is the dot product of vectors v and u
  * - |v| and |u| are the norms of vectors v and u respectively
  * 
+ * For complex vectors v·u is the Hermitian inner product, so the result is
+ * complex with a modulus of at most 1.
+ * 
  * @tparam K Numeric type used for calculation
  * @param v The first vector
  * @param u The second vector
@@ -107,11 +197,11 @@ Matrix<K> lerp(const Matrix<K> &M, const Matrix<K> &N, const f32 &t)
 template <typename K>
 K angle_cos(const Vector<K>& v, const Vector<K>& u)
 {
-    K v_norm = norm(v);
-    K u_norm = norm(u);
+    real_t<K> v_norm = norm(v);
+    real_t<K> u_norm = norm(u);
     if (u_norm == 0 || v_norm == 0)
         throw std::invalid_argument("Cannot computes cosinus for 0 vector");
-    return (dot(v, u) / (v_norm * u_norm));
+    return (dot(v, u) / K(v_norm * u_norm));
 }
 
 /**
@@ -128,10 +218,10 @@ K angle_cos(const Vector<K>& v, const Vector<K>& u)
 template<typename K>
 Vector<K> normalize(const Vector<K>& v)
 {
-    K tmp = norm(v);
+    real_t<K> tmp = norm(v);
     if (tmp == 0)
         throw std::invalid_argument("Cannot normalise vector of 0");
-    Vector<K> res = v * (1 / norm(v));
+    Vector<K> res = v * K(1 / tmp);
     return res;
 }
 
@@ -143,19 +233,16 @@ Vector<K> normalize(const Vector<K>& v)
  * 
  * @tparam K The numeric type of the vector elements
  * @param v The vector whose infinity norm will be calculated
- * @return K The infinity norm value
+ * @return real_t<K> The infinity norm value (the modulus for complex elements)
  * @throws std::runtime_error If the input vector is empty
  */
 template<typename K>
-K norm_inf(const Vector<K>& v)
+real_t<K> norm_inf(const Vector<K>& v)
 {
     if (v.getSize() == 0)
         throw std::runtime_error("Cannot find maximum of an empty vector");
-    K max_val = std::fabs(v[0]);
-    for (size_t i = 1; i < v.getSize(); ++i)
-        if (std::fabs(v[i]) > max_val)
-            max_val = std::fabs(v[i]);
-    return max_val;
+    const K* a = v.data();
+    return reduce_max<real_t<K>>(v.getSize(), [a](size_t i) { return magnitude(a[i]); });
 }
 
 /**
@@ -166,15 +253,14 @@ K norm_inf(const Vector<K>& v)
  * 
  * @tparam K The numeric data type of the vector components
  * @param v The input vector whose L1 norm will be calculated
- * @return K The L1 norm of the vector as a value of type K
+ * @param mode Summation::Fast (default), Pairwise or Kahan, see reduction.hpp
+ * @return real_t<K> The L1 norm of the vector (sum of moduli for complex elements)
  */
 template<typename K>
-K norm_1(const Vector<K>& v)
+real_t<K> norm_1(const Vector<K>& v, Summation mode = Summation::Fast)
 {
-    K res = std::fabs(v[0]);
-    for (size_t i = 1; i < v.getSize(); ++i)
-        res += std::fabs(v[i]);
-    return res;
+    const K* a = v.data();
+    return reduce_sum<real_t<K>>(v.getSize(), [a](size_t i) { return magnitude(a[i]); }, mode);
 }
 
 /**
@@ -185,14 +271,18 @@ K norm_1(const Vector<K>& v)
  * Mathematically: ||v|| = √(v·v) = √(v₁² + v₂² + ... + vₙ²)
  * 
  * @tparam K The numeric type used for the vector components
+ * For complex vectors the Hermitian dot product is used, v·v = Σ|vᵢ|², so the
+ * result is always real.
+ * 
  * @param v The vector whose norm is to be calculated
- * @return K The Euclidean norm of the vector, or 0 if the dot product is not positive
+ * @param mode Summation::Fast (default), Pairwise or Kahan, see reduction.hpp
+ * @return real_t<K> The Euclidean norm of the vector, or 0 if the dot product is not positive
  */
 template<typename K>
-K norm(const Vector<K>& v)
+real_t<K> norm(const Vector<K>& v, Summation mode = Summation::Fast)
 {
-    K res = dot(v, v);
-    return res > 0 ? sqrt(res) : 0;
+    real_t<K> res = ScalarTraits<K>::real(dot(v, v, mode));
+    return res > 0 ? std::sqrt(res) : 0;
 }
 
 /**
@@ -262,7 +352,7 @@ Matrix<K> row_echelon(const Matrix<K>& A)
             
         // Find the first row with non-zero entry in pivot column
         size_t pr = i; // pivot row
-        while (pr < rows && std::abs(result[pr][pc]) < K(1e-10))
+        while (pr < rows && magnitude(result[pr][pc]) < real_t<K>(1e-10))
             ++pr;
             
         // If no pivot found, move to next column
@@ -282,7 +372,7 @@ Matrix<K> row_echelon(const Matrix<K>& A)
         
         // Scale the pivot row to make pivot = 1
         K pv = result[i][pc];
-        if (std::abs(pv) > K(1e-10)) {
+        if (magnitude(pv) > real_t<K>(1e-10)) {
             for (size_t j = 0; j < cols; ++j)
                 result[i][j] /= pv;
         }
@@ -344,20 +434,16 @@ K det3(const Matrix<K>& A)
 }
 
 /**
- * @brief Calculates the determinant of a 4x4 matrix using cofactor expansion along the first row
+ * @brief Calculates the determinant of a 4x4 matrix from its 2x2 minors
  * 
- * This function computes the determinant of a 4x4 matrix by:
- * 1. Creating 3x3 minors for each element in the first row
- * 2. Computing the cofactor of each element (including appropriate sign)
- * 3. Multiplying each cofactor by its corresponding minor's determinant
- * 4. Summing the products to get the final determinant
+ * The determinant is Σ ±s·c over the six 2x2 minors s of rows 0-1 and the
+ * complementary minors c of rows 2-3 (Laplace expansion along two rows), see
+ * det4_kernel() in mat4.hpp. Nothing is allocated.
  * 
  * @tparam K The numeric type of the matrix elements
  * @param A The input 4x4 matrix
  * @return K The determinant value
  * @throws std::invalid_argument If the input matrix is not 4x4
- * 
- * @note This function depends on the det3() function to calculate determinants of 3x3 minors
  */
 template<typename K>
 K det4(const Matrix<K>& A)
@@ -365,22 +451,58 @@ K det4(const Matrix<K>& A)
     if (A.getCols() != 4 || A.getRows() != 4)
         throw std::invalid_argument("det4() should only be use on 4x4 matrixes");
 
-    K res = 0;
-    
-    for (int i = 0; i < 4; ++i) {
-        std::vector<std::vector<K>> minor;
-        for (int row = 1; row < 4; ++row) {
-            std::vector<K> newRow;
-            for (int col = 0; col < 4; ++col) {
-                if (col == i) continue;
-                newRow.push_back(A[row][col]);
-            }
-            minor.push_back(newRow);
-        }
-        K cofactor = (i % 2 == 0 ? 1 : -1) * A[0][i];
-        res += cofactor * det3(Matrix<K>(minor));
-    }
-    return res;
+    const K* a[4] = {A[0].data(), A[1].data(), A[2].data(), A[3].data()};
+    return det4_kernel(a);
+}
+
+// A must be a 4x4 transform, last row (0 0 0 1)
+template<typename K>
+void check_transform(const Matrix<K>& A, const char* message)
+{
+    if (A.getRows() != 4 || A.getCols() != 4 || A[3][0] != K(0) || A[3][1] != K(0)
+        || A[3][2] != K(0) || A[3][3] != K(1))
+        throw std::invalid_argument(message);
+}
+
+/**
+ * @brief Inverse of an affine transform [M | t; 0 0 0 1]
+ * 
+ * Computed as [M⁻¹ | -M⁻¹t; 0 0 0 1] with a closed-form 3x3 inverse.
+ * inverse() already takes this path for 4x4 matrices with that last row.
+ * 
+ * @throws std::invalid_argument If A is not 4x4 or its last row is not (0 0 0 1)
+ * @throws std::runtime_error If M is singular (|det M| < 1e-10·max|mij|³)
+ */
+template<typename K>
+Matrix<K> affine_inverse(const Matrix<K>& A)
+{
+    check_transform(A, "affine_inverse() should only be use on 4x4 affine matrixes");
+    Matrix<K> result(A);
+    const K* a[4] = {A[0].data(), A[1].data(), A[2].data(), A[3].data()};
+    K* out[4] = {result[0].data(), result[1].data(), result[2].data(), result[3].data()};
+    if (!affine_inverse4(a, out))
+        throw std::runtime_error("Matrix is singular and cannot be inverted");
+    return result;
+}
+
+/**
+ * @brief Inverse of a rigid-body transform [R | t; 0 0 0 1]
+ * 
+ * Computed as [Rᵀ | -Rᵀt; 0 0 0 1]: no division and no singularity test.
+ * R must be orthonormal (a rotation, possibly with a reflection); this is
+ * not checked, use affine_inverse() when R also scales or shears.
+ * 
+ * @throws std::invalid_argument If A is not 4x4 or its last row is not (0 0 0 1)
+ */
+template<typename K>
+Matrix<K> rigid_inverse(const Matrix<K>& A)
+{
+    check_transform(A, "rigid_inverse() should only be use on 4x4 affine matrixes");
+    Matrix<K> result(A);
+    const K* a[4] = {A[0].data(), A[1].data(), A[2].data(), A[3].data()};
+    K* out[4] = {result[0].data(), result[1].data(), result[2].data(), result[3].data()};
+    rigid_inverse4(a, out);
+    return result;
 }
 
 /**
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "complex.hpp"
+#include "reduction.hpp"
 #include <fstream>
 #include <vector>
 #include <iostream>
@@ -23,6 +25,12 @@ class Vector {
 
         Vector(const Vector<K>& other) : _data(other._data) {}
 
+        Vector<K>& operator=(const Vector<K>& other)
+        {
+            this->_data = other._data;
+            return *this;
+        }
+
         ~Vector() {}
         
     
@@ -30,6 +38,11 @@ class Vector {
         
         size_t getSize() const { return this->_data.size(); }
         void append(K value) { this->_data.push_back(value); }
+        void resize(size_t size, K value = K()) { this->_data.resize(size, value); }
+
+        // Raw access to the contiguous storage, used by the kernels that must not allocate
+        K* data() { return this->_data.data(); }
+        const K* data() const { return this->_data.data(); }
 
         // Methods
         void print() const {
@@ -180,11 +193,12 @@ class Vector {
          */
         K dot(const Vector<K>& v)
         {
-            Vector<K> tmp(v * (*this));
-            K res = 0;
-            for (size_t i = 0; i < this->getSize(); ++i)
-                res += tmp[i];
-            return res;
+            if (this->_data.size() != v.getSize()) {
+                throw std::invalid_argument("The vectors must have the same size.");
+            }
+            const K* a = this->_data.data();
+            const K* b = v.data();
+            return reduce_sum<K>(this->getSize(), [a, b](size_t i) { return conjugate(a[i]) * b[i]; });
         }
     
         /*========================= EX 04 =========================*/
@@ -197,16 +211,14 @@ class Vector {
         * @brief Return the biggest value of the vector.
         *
         * @return K The biggest value.
+        * @throws std::runtime_error If the vector is empty
         */
         K max() const
         {
             if (this->getSize() == 0)
                 throw std::runtime_error("Cannot find maximum of an empty vector");
-            K max_val = (*this)[0];
-            for (size_t i = 1; i < this->getSize(); ++i)
-                if ((*this)[i] > max_val)
-                    max_val = (*this)[i];
-            return max_val;
+            const K* a = this->_data.data();
+            return reduce_max<K>(this->getSize(), [a](size_t i) { return a[i]; });
         }
 
         /**
@@ -235,10 +247,10 @@ class Vector {
          */
         void normalize()
         {
-            K tmp = norm(*this);
+            real_t<K> tmp = norm(*this);
             if (tmp == 0)
                 throw std::invalid_argument("Cannot normalise vector of 0");
-            this->scl(1 / tmp);
+            this->scl(K(1 / tmp));
         }
 
 
@@ -396,21 +408,47 @@ bool operator==(const Vector<K>& v, const Vector<K>& u) {
  * @brief Computes the dot product of two vectors.
  * 
  * The dot product is calculated as the sum of the products of the corresponding elements
- * of the two vectors.
+ * of the two vectors. For complex vectors this is the Hermitian inner product
+ * Σ conj(vᵢ)·uᵢ, so that dot(v, v) is the squared norm.
  * 
- * @param v First vector
+ * @param v First vector (conjugated when K is complex)
  * @param u Second vector
+ * @param mode Summation::Fast (default), Pairwise or Kahan, see reduction.hpp
  * @return The dot product of the two vectors
  * @throws std::invalid_argument If the vectors do not have the same size
  */
 template<typename K>
-K dot(const Vector<K>& v, const Vector<K>& u)
+K dot(const Vector<K>& v, const Vector<K>& u, Summation mode = Summation::Fast)
+{
+    if (u.getSize() != v.getSize()) {
+        throw std::invalid_argument("The vectors must have the same size.");
+    }
+    const K* a = v.data();
+    const K* b = u.data();
+    return reduce_sum<K>(u.getSize(), [a, b](size_t i) { return conjugate(a[i]) * b[i]; }, mode);
+}
+
+/**
+ * @brief Adds a scaled vector to y in place: y ← a·x + y
+ * 
+ * Unlike `y += x * a` no temporary vector is built, which keeps the inner
+ * loops of the iterative solvers allocation free.
+ * 
+ * @param a The scalar applied to x
+ * @param x The vector to add
+ * @param y The vector updated in place
+ * @throws std::invalid_argument If the vectors do not have the same size
+ */
+template<typename K>
+void axpy(const K& a, const Vector<K>& x, Vector<K>& y)
 {
-    Vector<K> tmp(v * u);
-    K res = 0;
-    for (size_t i = 0; i < u.getSize(); ++i)
-        res += tmp[i];
-    return res;
+    if (x.getSize() != y.getSize()) {
+        throw std::invalid_argument("The vectors must have the same size.");
+    }
+    const K* src = x.data();
+    K* dst = y.data();
+    for (size_t i = 0; i < y.getSize(); ++i)
+        dst[i] += a * src[i];
 }
 
 